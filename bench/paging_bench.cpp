@@ -0,0 +1,290 @@
+#include "mmu.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+/* ===================================================
+   Page-Table Microbenchmark
+   ===================================================
+   For every engine x access pattern x working-set size:
+     1. Fault pass  - on an empty table, fault in every page the stream
+                      touches, in first-touch order (frame = next free
+                      number): faults/sec.
+     2. Warmup      - `warmup` untimed translation passes.
+     3. Timed reps  - `reps` passes; report median/min/max ns per
+                      translation.
+   Results go to stdout as CSV (default) or JSON; progress to stderr.
+
+   Usage: paging_bench key=value ...
+     engines=linear,2level,4level,adaptive,inverted,clustered
+     patterns=seq,uniform,zipf
+     sizes=1024,16384,262144,1048576 (pages)  accesses=4194304
+     spread=1 (VPN distance between touched pages; 512 = one per 2 MiB)
+     reps=5 warmup=1 seed=42 format=csv|json
+     path=walk|mmu|both (walk)  tlb=64 (TLB entries on the mmu path)  */
+
+/* ===================================================
+   SECTION 1: Engine Adapters (static dispatch)
+   ===================================================
+   Both adapters wrap a backend from backends.h:
+     TableEngine<B>  bare page-table walk (path=walk)
+     MmuEngine<B>    full Mmu<B, TLB>: TLB, walk, frame manager
+                     (path=mmu); frames >= pages touched: no evictions */
+
+const u64 BENCH_PID = 1;
+
+template <class Backend>
+struct TableEngine {
+    static const char* name() { return Backend::name(); }
+    static const char* path() { return "walk"; }
+    static u64 max_pages() { return Backend::max_pages(); }
+    Backend table;
+    u64 next_frame = 0;
+    TableEngine(u64 pages, u64 span, int) : table(span, pages) {}
+
+    inline long long translate(u64 VA) {
+        long long pfn = table.lookup(BENCH_PID, VA >> 12);
+        return pfn < 0 ? -1 : (pfn << 12) | (long long)(VA & 0xFFF);
+    }
+    // Miss walk + map, as a fault handler would
+    inline void fault_in(u64 VA) {
+        if (translate(VA) < 0) table.map(BENCH_PID, VA >> 12, next_frame++);
+    }
+    u64 table_bytes() const { return table.table_bytes(); }
+};
+
+template <class Backend>
+struct MmuEngine {
+    static const char* name() { return Backend::name(); }
+    static const char* path() { return "mmu"; }
+    static u64 max_pages() { return Backend::max_pages(); }
+    Mmu<Backend> mmu;
+    MmuEngine(u64 pages, u64 span, int tlb_entries)
+        : mmu(pages, TLB(tlb_entries, TLB_ASID_TAGGED), span) {}
+
+    inline long long translate(u64 VA) { return mmu.translate(BENCH_PID, VA, false); }
+    inline void fault_in(u64 VA) { mmu.translate(BENCH_PID, VA, false); }
+    u64 table_bytes() const { return mmu.table.table_bytes(); }
+};
+
+/* ===================================================
+   SECTION 2: Measurement
+   =================================================== */
+
+struct BenchResult {
+    string engine, path, pattern;
+    u64 pages, accesses, faults;
+    int reps;
+    double faults_per_sec;
+    double ns_median, ns_min, ns_max;
+    u64 table_bytes;
+    u64 checksum;
+};
+
+typedef chrono::steady_clock Clock;
+
+inline double seconds_since(Clock::time_point t0) {
+    return chrono::duration<double>(Clock::now() - t0).count();
+}
+
+struct BenchStream {
+    vector<u64> accesses;
+    vector<u64> first_touch; // Distinct pages in the order the stream reaches them
+    u64 span = 0;            // Highest VPN + 1
+};
+
+template <class Engine>
+BenchResult Run_Case(const string& pattern, u64 pages, const BenchStream& bs, int warmup, int reps,
+                     int tlb_entries) {
+    const vector<u64>& stream = bs.accesses;
+    // Frames for every page touched, so the MMU path never evicts
+    u64 frames = max<u64>(pages, bs.first_touch.size());
+    Engine engine(frames, bs.span, tlb_entries);
+    BenchResult r{Engine::name(), Engine::path(), pattern, pages, stream.size(), 0, reps, 0, 0, 0, 0, 0, 0};
+
+    // 1. Fault pass: every page once, in first-touch order
+    auto t0 = Clock::now();
+    for (u64 va : bs.first_touch) engine.fault_in(va);
+    double fault_secs = seconds_since(t0);
+    r.faults = bs.first_touch.size();
+    r.faults_per_sec = fault_secs > 0 ? r.faults / fault_secs : 0;
+
+    // 2. Warmup + 3. Timed reps
+    u64 sum = 0;
+    for (int w = 0; w < warmup; ++w) {
+        for (u64 va : stream) sum += (u64)engine.translate(va);
+    }
+    vector<double> ns(reps);
+    for (int k = 0; k < reps; ++k) {
+        t0 = Clock::now();
+        for (u64 va : stream) sum += (u64)engine.translate(va);
+        ns[k] = seconds_since(t0) * 1e9 / stream.size();
+    }
+    sort(ns.begin(), ns.end());
+    r.ns_median = ns[reps / 2];
+    r.ns_min = ns.front();
+    r.ns_max = ns.back();
+    r.table_bytes = engine.table_bytes();
+    r.checksum = sum;
+    return r;
+}
+
+/* ===================================================
+   SECTION 3: Output
+   =================================================== */
+
+void Print_CSV(const vector<BenchResult>& results) {
+    printf("engine,path,pattern,pages,accesses,reps,faults,faults_per_sec,ns_median,ns_min,ns_max,table_bytes\n");
+    for (const BenchResult& r : results) {
+        printf("%s,%s,%s,%llu,%llu,%d,%llu,%.0f,%.3f,%.3f,%.3f,%llu\n",
+               r.engine.c_str(), r.path.c_str(), r.pattern.c_str(), (unsigned long long)r.pages,
+               (unsigned long long)r.accesses, r.reps, (unsigned long long)r.faults,
+               r.faults_per_sec, r.ns_median, r.ns_min, r.ns_max, (unsigned long long)r.table_bytes);
+    }
+}
+
+void Print_JSON(const vector<BenchResult>& results) {
+    printf("[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        printf("  {\"engine\": \"%s\", \"path\": \"%s\", \"pattern\": \"%s\", \"pages\": %llu, \"accesses\": %llu, "
+               "\"reps\": %d, \"faults\": %llu, \"faults_per_sec\": %.0f, \"ns_median\": %.3f, "
+               "\"ns_min\": %.3f, \"ns_max\": %.3f, \"table_bytes\": %llu}%s\n",
+               r.engine.c_str(), r.path.c_str(), r.pattern.c_str(), (unsigned long long)r.pages,
+               (unsigned long long)r.accesses, r.reps, (unsigned long long)r.faults,
+               r.faults_per_sec, r.ns_median, r.ns_min, r.ns_max, (unsigned long long)r.table_bytes,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("]\n");
+}
+
+/* ===================================================
+   SECTION 4: Main
+   =================================================== */
+
+vector<string> split(const string& s) {
+    vector<string> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+BenchStream Build_Stream(const string& pattern, u64 pages, u64 spread, u64 accesses, u64 seed) {
+    WorkloadSpec spec;
+    Parse_Workload_Pattern(pattern, spec.pattern);
+    spec.footprint_pages = pages;
+    spec.spread_pages = spread;
+    spec.seed = seed;
+    spec.base_va = 0; // Keep every engine (incl. the 32-bit one) in range
+
+    BenchStream bs;
+    bs.accesses.reserve(accesses);
+    // Patterns like phased reach beyond the footprint: track what is touched
+    unordered_set<u64> seen;
+    WorkloadGenerator gen(spec);
+    gen.run(accesses, [&](const TraceRecord& rec) {
+        bs.accesses.push_back(rec.va);
+        u64 vpn = rec.va >> 12;
+        if (seen.insert(vpn).second) bs.first_touch.push_back(rec.va);
+        if (vpn + 1 > bs.span) bs.span = vpn + 1;
+    });
+    return bs;
+}
+
+template <class Engine>
+void Maybe_Run(const vector<string>& engines, const string& pattern, u64 pages,
+               const BenchStream& stream, int warmup, int reps, int tlb_entries,
+               vector<BenchResult>& out) {
+    if (find(engines.begin(), engines.end(), Engine::name()) == engines.end()) return;
+    if (stream.span > Engine::max_pages()) {
+        fprintf(stderr, "  %-9s skipped (%llu pages exceeds its address space)\n",
+                Engine::name(), (unsigned long long)stream.span);
+        return;
+    }
+    out.push_back(Run_Case<Engine>(pattern, pages, stream, warmup, reps, tlb_entries));
+    const BenchResult& r = out.back();
+    fprintf(stderr, "  %-9s %-4s %8.2f ns/translation  %12.0f faults/s  %10llu table bytes\n",
+            r.engine.c_str(), r.path.c_str(), r.ns_median, r.faults_per_sec, (unsigned long long)r.table_bytes);
+}
+
+int main(int argc, char** argv) {
+    vector<string> engines = {"linear", "2level", "4level", "adaptive", "inverted", "clustered"};
+    vector<string> patterns = {"seq", "uniform", "zipf"};
+    vector<string> sizes = {"1024", "16384", "262144", "1048576"};
+    u64 accesses = 1 << 22;
+    int reps = 5, warmup = 1, tlb_entries = 64;
+    u64 seed = 42, spread = 1;
+    string format = "csv";
+    string path = "walk";
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), val = (eq == string::npos) ? "" : arg.substr(eq + 1);
+        if (key == "engines") engines = split(val);
+        else if (key == "patterns") patterns = split(val);
+        else if (key == "sizes") sizes = split(val);
+        else if (key == "accesses") accesses = stoull(val);
+        else if (key == "reps") reps = max(1, stoi(val));
+        else if (key == "warmup") warmup = stoi(val);
+        else if (key == "seed") seed = stoull(val);
+        else if (key == "spread") spread = max<u64>(1, stoull(val));
+        else if (key == "format") format = val;
+        else if (key == "path") path = val;
+        else if (key == "tlb") tlb_entries = max(1, stoi(val));
+        else {
+            fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    vector<BenchResult> results;
+    for (const string& pattern : patterns) {
+        WorkloadPattern check;
+        if (!Parse_Workload_Pattern(pattern, check)) {
+            fprintf(stderr, "Unknown pattern '%s'\n", pattern.c_str());
+            return 1;
+        }
+        for (const string& size : sizes) {
+            u64 pages = stoull(size);
+            if (pages == 0) {
+                fprintf(stderr, "Working-set size must be at least 1 page\n");
+                return 1;
+            }
+            fprintf(stderr, "[%s, %llu pages, %llu accesses]\n", pattern.c_str(),
+                    (unsigned long long)pages, (unsigned long long)accesses);
+            BenchStream stream = Build_Stream(pattern, pages, spread, accesses, seed);
+
+            if (path == "walk" || path == "both") {
+                Maybe_Run<TableEngine<LinearBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<TableEngine<TwoLevelBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<TableEngine<FourLevelBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<TableEngine<AdaptiveBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<TableEngine<InvertedBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<TableEngine<ClusteredBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+            }
+            if (path == "mmu" || path == "both") {
+                Maybe_Run<MmuEngine<LinearBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<MmuEngine<TwoLevelBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<MmuEngine<FourLevelBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<MmuEngine<AdaptiveBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<MmuEngine<InvertedBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+                Maybe_Run<MmuEngine<ClusteredBackend>>(engines, pattern, pages, stream, warmup, reps, tlb_entries, results);
+            }
+        }
+    }
+
+    if (format == "json") Print_JSON(results);
+    else Print_CSV(results);
+    return 0;
+}
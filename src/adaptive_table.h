@@ -0,0 +1,371 @@
+#ifndef ADAPTIVE_TABLE_H
+#define ADAPTIVE_TABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Adaptive Radix Page Table
+   ===================================================
+   The same 4 x 9-bit VPN split as the M5 tree (paging_v2.h), but each
+   node is only as large as its population:
+       Node4, Node16   keys + slots, linear scan
+       Node48          512-byte key index into 48 slots
+       Node512         direct array, like a PageTableV2
+   A full node grows into the next type; unmapping shrinks it back once
+   it is well below the smaller type's capacity (so a count hovering at
+   a boundary does not flip the type on every map/unmap). Empty
+   non-root nodes are freed. A page alone in its 1 GiB region costs
+   three Node4s (~150 bytes) instead of three 8 KiB tables, and a walk
+   is still at most four node visits.                                  */
+
+const int ART_LEVELS = 4;
+const int ART_BITS = 9;
+const int ART_FANOUT = 1 << ART_BITS;
+const uint8_t ART_NO_SLOT = 0xFF;   // Node48 index value for an absent key
+const uint16_t ART_NO_KEY = 0xFFFF; // Unused Node4/16 key; lets the scan run a fixed trip count
+
+enum ArtType : uint8_t { ART_NODE4 = 0, ART_NODE16 = 1, ART_NODE48 = 2, ART_NODE512 = 3 };
+
+const int ART_CAPACITY[4] = {4, 16, 48, ART_FANOUT};
+const int ART_SHRINK_AT[4] = {0, 2, 12, 40}; // Shrink to the previous type at or below this count
+
+struct ArtNode {
+    uint8_t type;
+    uint8_t level;
+    uint16_t count;
+};
+
+// Branch levels hold child pointers, the last level holds frames
+union ArtSlot {
+    ArtNode* child;
+    u64 frame;
+};
+
+struct ArtNode4 : ArtNode {
+    uint16_t keys[4];
+    ArtSlot slots[4];
+};
+
+struct ArtNode16 : ArtNode {
+    uint16_t keys[16];
+    ArtSlot slots[16];
+};
+
+struct ArtNode48 : ArtNode {
+    u64 used; // Bitmap of occupied slots
+    uint8_t index[ART_FANOUT];
+    ArtSlot slots[48];
+};
+
+struct ArtNode512 : ArtNode {
+    u64 valid[ART_FANOUT / 64];
+    ArtSlot slots[ART_FANOUT];
+};
+
+// A whole tree plus its memory accounting
+struct AdaptiveTree {
+    ArtNode* root = nullptr;
+    u64 bytes_live = 0;
+    u64 nodes_live = 0;
+    u64 nodes_by_type[4] = {0, 0, 0, 0};
+    u64 grows = 0;
+    u64 shrinks = 0;
+};
+
+// --- Helpers ---
+inline unsigned Art_Index(u64 vpn, int level) {
+    return (unsigned)(vpn >> (ART_BITS * (ART_LEVELS - 1 - level))) & (ART_FANOUT - 1);
+}
+
+inline u64 Art_Node_Bytes(int type) {
+    static const u64 bytes[4] = {sizeof(ArtNode4), sizeof(ArtNode16), sizeof(ArtNode48), sizeof(ArtNode512)};
+    return bytes[type];
+}
+
+inline ArtNode* Art_New(AdaptiveTree* tree, int type, int level) {
+    ArtNode* n;
+    switch (type) {
+        case ART_NODE4: {
+            ArtNode4* m = new ArtNode4();
+            std::fill(m->keys, m->keys + 4, ART_NO_KEY);
+            n = m;
+            break;
+        }
+        case ART_NODE16: {
+            ArtNode16* m = new ArtNode16();
+            std::fill(m->keys, m->keys + 16, ART_NO_KEY);
+            n = m;
+            break;
+        }
+        case ART_NODE48: {
+            ArtNode48* m = new ArtNode48();
+            m->used = 0;
+            std::memset(m->index, ART_NO_SLOT, sizeof(m->index));
+            n = m;
+            break;
+        }
+        default: {
+            ArtNode512* m = new ArtNode512();
+            std::memset(m->valid, 0, sizeof(m->valid));
+            n = m;
+            break;
+        }
+    }
+    n->type = (uint8_t)type;
+    n->level = (uint8_t)level;
+    n->count = 0;
+    tree->bytes_live += Art_Node_Bytes(type);
+    tree->nodes_live++;
+    tree->nodes_by_type[type]++;
+    return n;
+}
+
+inline void Art_Delete(AdaptiveTree* tree, ArtNode* n) {
+    tree->bytes_live -= Art_Node_Bytes(n->type);
+    tree->nodes_live--;
+    tree->nodes_by_type[n->type]--;
+    switch (n->type) {
+        case ART_NODE4:  delete static_cast<ArtNode4*>(n); break;
+        case ART_NODE16: delete static_cast<ArtNode16*>(n); break;
+        case ART_NODE48: delete static_cast<ArtNode48*>(n); break;
+        default:         delete static_cast<ArtNode512*>(n); break;
+    }
+}
+
+// Slot for `key`, or nullptr
+inline ArtSlot* Art_Find(ArtNode* n, unsigned key) {
+    switch (n->type) {
+        case ART_NODE4: {
+            ArtNode4* m = static_cast<ArtNode4*>(n);
+            for (int i = 0; i < 4; ++i) {
+                if (m->keys[i] == key) return &m->slots[i];
+            }
+            return nullptr;
+        }
+        case ART_NODE16: {
+            // Branch-free compare of all 16 keys, then one jump
+            ArtNode16* m = static_cast<ArtNode16*>(n);
+            unsigned hits = 0;
+            for (int i = 0; i < 16; ++i) hits |= (unsigned)(m->keys[i] == key) << i;
+            return hits ? &m->slots[__builtin_ctz(hits)] : nullptr;
+        }
+        case ART_NODE48: {
+            ArtNode48* m = static_cast<ArtNode48*>(n);
+            uint8_t i = m->index[key];
+            return i == ART_NO_SLOT ? nullptr : &m->slots[i];
+        }
+        default: {
+            ArtNode512* m = static_cast<ArtNode512*>(n);
+            return (m->valid[key >> 6] >> (key & 63) & 1) ? &m->slots[key] : nullptr;
+        }
+    }
+}
+
+// Calls f(key, slot) for every entry: keys in insertion order for
+// Node4/16, ascending for Node48/512
+template <class F>
+inline void Art_For_Each(const ArtNode* n, F f) {
+    switch (n->type) {
+        case ART_NODE4: {
+            const ArtNode4* m = static_cast<const ArtNode4*>(n);
+            for (int i = 0; i < m->count; ++i) f(m->keys[i], m->slots[i]);
+            break;
+        }
+        case ART_NODE16: {
+            const ArtNode16* m = static_cast<const ArtNode16*>(n);
+            for (int i = 0; i < m->count; ++i) f(m->keys[i], m->slots[i]);
+            break;
+        }
+        case ART_NODE48: {
+            const ArtNode48* m = static_cast<const ArtNode48*>(n);
+            for (unsigned k = 0; k < (unsigned)ART_FANOUT; ++k) {
+                if (m->index[k] != ART_NO_SLOT) f(k, m->slots[m->index[k]]);
+            }
+            break;
+        }
+        default: {
+            const ArtNode512* m = static_cast<const ArtNode512*>(n);
+            for (unsigned k = 0; k < (unsigned)ART_FANOUT; ++k) {
+                if (m->valid[k >> 6] >> (k & 63) & 1) f(k, m->slots[k]);
+            }
+            break;
+        }
+    }
+}
+
+// Adds an absent key to a node with room; returns its slot
+inline ArtSlot* Art_Insert_Raw(ArtNode* n, unsigned key, ArtSlot value) {
+    ArtSlot* s;
+    switch (n->type) {
+        case ART_NODE4: {
+            ArtNode4* m = static_cast<ArtNode4*>(n);
+            m->keys[m->count] = (uint16_t)key;
+            s = &m->slots[m->count];
+            break;
+        }
+        case ART_NODE16: {
+            ArtNode16* m = static_cast<ArtNode16*>(n);
+            m->keys[m->count] = (uint16_t)key;
+            s = &m->slots[m->count];
+            break;
+        }
+        case ART_NODE48: {
+            ArtNode48* m = static_cast<ArtNode48*>(n);
+            int i = __builtin_ctzll(~m->used);
+            m->used |= 1ULL << i;
+            m->index[key] = (uint8_t)i;
+            s = &m->slots[i];
+            break;
+        }
+        default: {
+            ArtNode512* m = static_cast<ArtNode512*>(n);
+            m->valid[key >> 6] |= 1ULL << (key & 63);
+            s = &m->slots[key];
+            break;
+        }
+    }
+    *s = value;
+    n->count++;
+    return s;
+}
+
+// Removes a present key from a node; never resizes
+inline void Art_Erase_Raw(ArtNode* n, unsigned key) {
+    switch (n->type) {
+        case ART_NODE4:
+        case ART_NODE16: {
+            // Node4 and Node16 share the layout up to their capacity
+            uint16_t* keys = n->type == ART_NODE4 ? static_cast<ArtNode4*>(n)->keys : static_cast<ArtNode16*>(n)->keys;
+            ArtSlot* slots = n->type == ART_NODE4 ? static_cast<ArtNode4*>(n)->slots : static_cast<ArtNode16*>(n)->slots;
+            int last = n->count - 1;
+            for (int i = 0; i <= last; ++i) {
+                if (keys[i] != key) continue;
+                keys[i] = keys[last];
+                slots[i] = slots[last];
+                keys[last] = ART_NO_KEY;
+                break;
+            }
+            break;
+        }
+        case ART_NODE48: {
+            ArtNode48* m = static_cast<ArtNode48*>(n);
+            m->used &= ~(1ULL << m->index[key]);
+            m->index[key] = ART_NO_SLOT;
+            break;
+        }
+        default: {
+            ArtNode512* m = static_cast<ArtNode512*>(n);
+            m->valid[key >> 6] &= ~(1ULL << (key & 63));
+            break;
+        }
+    }
+    n->count--;
+}
+
+// Moves every entry of *ref into a new node of `type`, in place in the parent
+inline void Art_Resize(AdaptiveTree* tree, ArtNode** ref, int type) {
+    ArtNode* old = *ref;
+    ArtNode* n = Art_New(tree, type, old->level);
+    Art_For_Each(old, [&](unsigned key, ArtSlot s) { Art_Insert_Raw(n, key, s); });
+    Art_Delete(tree, old);
+    *ref = n;
+}
+
+// Adds an absent key, growing the node first when it is full
+inline ArtSlot* Art_Add(AdaptiveTree* tree, ArtNode** ref, unsigned key, ArtSlot value) {
+    if ((*ref)->count == ART_CAPACITY[(*ref)->type]) {
+        Art_Resize(tree, ref, (*ref)->type + 1);
+        tree->grows++;
+    }
+    return Art_Insert_Raw(*ref, key, value);
+}
+
+// Removes a present key, shrinking the node if it became sparse.
+// An emptied non-root node is left for the caller to free.
+inline void Art_Remove(AdaptiveTree* tree, ArtNode** ref, unsigned key) {
+    ArtNode* n = *ref;
+    Art_Erase_Raw(n, key);
+    if (n->type == ART_NODE4 || n->count > ART_SHRINK_AT[n->type]) return;
+    if (n->count == 0 && n->level > 0) return;
+    Art_Resize(tree, ref, n->type - 1);
+    tree->shrinks++;
+}
+
+inline u64 Art_Bytes(const AdaptiveTree* tree) { return tree->bytes_live; }
+
+// --- Lookup (Read Path): never allocates. Frame or -1 ---
+inline long long Art_Lookup(AdaptiveTree* tree, u64 vpn) {
+    ArtNode* n = tree->root;
+    if (n == nullptr) return -1;
+    for (int level = 0; level < ART_LEVELS - 1; ++level) {
+        ArtSlot* s = Art_Find(n, Art_Index(vpn, level));
+        if (s == nullptr) return -1;
+        n = s->child;
+    }
+    ArtSlot* leaf = Art_Find(n, Art_Index(vpn, ART_LEVELS - 1));
+    return leaf ? (long long)leaf->frame : -1;
+}
+
+// --- Map (Builder): creates missing Node4s on the path, then the leaf ---
+inline void Art_Map(AdaptiveTree* tree, u64 vpn, u64 frame) {
+    if (tree->root == nullptr) tree->root = Art_New(tree, ART_NODE4, 0);
+    ArtNode** ref = &tree->root;
+    for (int level = 0; level < ART_LEVELS - 1; ++level) {
+        unsigned key = Art_Index(vpn, level);
+        ArtSlot* s = Art_Find(*ref, key);
+        if (s == nullptr) {
+            ArtSlot child;
+            child.child = Art_New(tree, ART_NODE4, level + 1);
+            s = Art_Add(tree, ref, key, child);
+        }
+        ref = &s->child;
+    }
+
+    unsigned key = Art_Index(vpn, ART_LEVELS - 1);
+    ArtSlot* leaf = Art_Find(*ref, key);
+    if (leaf != nullptr) {
+        leaf->frame = frame;
+        return;
+    }
+    ArtSlot value;
+    value.frame = frame;
+    Art_Add(tree, ref, key, value);
+}
+
+// --- Unmap: removes the leaf, frees emptied nodes, shrinks sparse ones ---
+// Returns the frame that was mapped, or -1 if the page was not present.
+inline long long Art_Unmap(AdaptiveTree* tree, u64 vpn) {
+    if (tree->root == nullptr) return -1;
+    ArtNode** path[ART_LEVELS];
+    ArtNode** ref = &tree->root;
+    long long frame = -1;
+    for (int level = 0; level < ART_LEVELS; ++level) {
+        path[level] = ref;
+        ArtSlot* s = Art_Find(*ref, Art_Index(vpn, level));
+        if (s == nullptr) return -1;
+        if (level < ART_LEVELS - 1) ref = &s->child;
+        else frame = (long long)s->frame;
+    }
+
+    // Walk back up: an emptied child is freed and removed from its parent
+    for (int level = ART_LEVELS - 1; level >= 0; --level) {
+        Art_Remove(tree, path[level], Art_Index(vpn, level));
+        if (level == 0 || (*path[level])->count > 0) break;
+        Art_Delete(tree, *path[level]);
+    }
+    return frame;
+}
+
+// --- Teardown ---
+inline void Art_Free_Subtree(AdaptiveTree* tree, ArtNode* n) {
+    if (n->level < ART_LEVELS - 1) {
+        Art_For_Each(n, [&](unsigned, ArtSlot s) { Art_Free_Subtree(tree, s.child); });
+    }
+    Art_Delete(tree, n);
+}
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef BACKENDS_H
+#define BACKENDS_H
+
+#include "adaptive_table.h"
+#include "clustered_table.h"
+#include "inverted_table.h"
+#include "linear_table.h"
+#include "paging.h"
+#include "paging_v2.h"
+
+#include <cstdint>
+#include <map>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Page-Table Backends
+   ===================================================
+   Each page-table design is wrapped in the same shape so the MMU
+   (mmu.h), the replay driver and the benchmark can be instantiated
+   over any of them. Dispatch is static: no virtual calls on the hot
+   path. A backend provides:
+
+     Backend(u64 virtual_pages, u64 frames)
+     static const char* name();
+     static u64 max_pages();               largest VPN + 1 it can map
+     bool in_range(u64 vpn) const;         vpn is mappable in this instance
+                                           (linear: below virtual_pages)
+     long long lookup(u64 pid, u64 vpn);   PFN or -1; never allocates
+     long long peek(u64 pid, u64 vpn);     the same without side effects
+                                           (a TLB fill reading neighbours)
+     bool map(u64 pid, u64 vpn, u64 pfn);  false = segmentation fault
+     long long unmap(u64 pid, u64 vpn);    old PFN or -1; prunes empty
+                                           tables where the design can
+     u64 table_bytes() const;              memory held by the tables
+
+   The per-process radix designs (2level, 4level) also keep a hardware
+   accessed bit in each PTE, set when a walk finds it (a new mapping
+   starts clear), and offer an aging walk over every table (mglru.h):
+
+     template <class F>
+     void age_walk(F young, u64* tables, u64* ptes);
+                                           clears every set accessed bit
+                                           and calls young(pid, vpn, pfn)
+                                           for it; counts what it read
+     bool clear_accessed(pid, vpn);        one PTE's bit (test and clear)
+
+   The designs a hardware walker reads (linear, 2level, 4level) can
+   replay a walk's PTE loads for the cache model (cache.h):
+
+     template <class F>
+     void walk_refs(u64 pid, u64 vpn, F ref);
+                                           ref(table, offset) per entry
+                                           loaded, root first; `table`
+                                           names one table page of the
+                                           process, `offset` is the byte
+                                           at the entry's hardware size
+
+   Per-process designs keep one table per PID (the CR3 of each
+   process); the inverted and clustered tables are shared by
+   construction.                                                      */
+
+// --- One table per PID, with the last one cached (the loaded CR3) ---
+template <class Table>
+struct ProcessTables {
+    std::map<u64, Table*> by_pid; // Ordered: PID walks repeat exactly after a restore
+    u64 cached_pid = ~0ULL;
+    Table* cached = nullptr;
+
+    // nullptr if the process has never mapped anything
+    inline Table* find(u64 pid) {
+        if (pid == cached_pid) return cached;
+        auto it = by_pid.find(pid);
+        if (it == by_pid.end()) return nullptr;
+        cached_pid = pid;
+        cached = it->second;
+        return cached;
+    }
+
+    template <class Make>
+    inline Table* get(u64 pid, Make make) {
+        Table* t = find(pid);
+        if (t != nullptr) return t;
+        t = make();
+        by_pid[pid] = t;
+        cached_pid = pid;
+        cached = t;
+        return t;
+    }
+};
+
+/* ---------------------------------------------------
+   Linear: one flat array of PTEs per process (M3)   */
+struct LinearBackend {
+    static const char* name() { return "linear"; }
+    static u64 max_pages() { return 1ULL << 24; }
+
+    u64 virtual_pages;
+    ProcessTables<LinearPageTable> procs;
+
+    LinearBackend(u64 pages, u64) : virtual_pages(pages < max_pages() ? pages : max_pages()) {}
+    ~LinearBackend() { for (auto& p : procs.by_pid) delete p.second; }
+
+    bool in_range(u64 vpn) const { return vpn < virtual_pages; }
+
+    inline long long lookup(u64 pid, u64 vpn) {
+        LinearPageTable* t = procs.find(pid);
+        if (t == nullptr) return -1;
+        LinearPTE* pte = Linear_Lookup(t, vpn);
+        return pte ? pte->frame_number : -1;
+    }
+    inline long long peek(u64 pid, u64 vpn) { return lookup(pid, vpn); }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        if (vpn >= virtual_pages) return false;
+        return Linear_Map(procs.get(pid, [&] { return new LinearPageTable(virtual_pages); }), vpn, pfn);
+    }
+    inline long long unmap(u64 pid, u64 vpn) {
+        LinearPageTable* t = procs.find(pid);
+        return t ? Linear_Unmap(t, vpn) : -1;
+    }
+    u64 table_bytes() const {
+        u64 bytes = 0;
+        for (auto& p : procs.by_pid) bytes += Linear_Bytes(p.second);
+        return bytes;
+    }
+
+    // One 8-byte PTE; the flat array spans one table page per 512 VPNs
+    template <class F>
+    void walk_refs(u64 pid, u64 vpn, F ref) {
+        if (procs.find(pid) == nullptr || vpn >= virtual_pages) return;
+        ref(vpn >> 9, (vpn & 511) * 8);
+    }
+};
+
+/* ---------------------------------------------------
+   Two-Level: 32-bit PageDirectory per process (M4)  */
+struct TwoLevelBackend {
+    static const char* name() { return "2level"; }
+    static u64 max_pages() { return 1ULL << 20; }
+    bool in_range(u64 vpn) const { return vpn < max_pages(); }
+
+    ProcessTables<PageDirectory> procs;
+    u64 tables_live = 0;
+
+    TwoLevelBackend(u64, u64) {}
+    ~TwoLevelBackend() {
+        for (auto& p : procs.by_pid) {
+            for (PageTable* pt : p.second->tables) delete pt;
+            delete p.second;
+        }
+    }
+
+    inline long long lookup(u64 pid, u64 vpn) {
+        PageDirectory* dir = procs.find(pid);
+        if (dir == nullptr || vpn >= max_pages()) return -1;
+        PageTableEntry* pte = PD_Lookup(dir, (uint32_t)(vpn << 12));
+        if (pte == nullptr || !pte->valid) return -1;
+        pte->accessed = true;
+        return pte->frame_number;
+    }
+    inline long long peek(u64 pid, u64 vpn) {
+        PageDirectory* dir = procs.find(pid);
+        if (dir == nullptr || vpn >= max_pages()) return -1;
+        PageTableEntry* pte = PD_Lookup(dir, (uint32_t)(vpn << 12));
+        return (pte && pte->valid) ? pte->frame_number : -1;
+    }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        if (vpn >= max_pages()) return false;
+        PageDirectory* dir = procs.get(pid, [] { return new PageDirectory(); });
+        tables_live += PD_Map(dir, (uint32_t)(vpn << 12), (int)pfn);
+        return true;
+    }
+    inline long long unmap(u64 pid, u64 vpn) {
+        PageDirectory* dir = procs.find(pid);
+        if (dir == nullptr || vpn >= max_pages()) return -1;
+        bool freed;
+        int frame = PD_Unmap(dir, (uint32_t)(vpn << 12), &freed);
+        tables_live -= freed;
+        return frame;
+    }
+    u64 table_bytes() const {
+        return procs.by_pid.size() * sizeof(PageDirectory) + tables_live * sizeof(PageTable);
+    }
+
+    template <class F>
+    void age_walk(F young, u64* tables, u64* ptes) {
+        for (auto& p : procs.by_pid) {
+            for (u64 d = 0; d < 1024; ++d) {
+                PageTable* pt = p.second->tables[d];
+                if (pt == nullptr) continue;
+                (*tables)++;
+                *ptes += 1024;
+                for (u64 i = 0; i < 1024; ++i) {
+                    PageTableEntry& e = pt->entries[i];
+                    if (!e.valid || !e.accessed) continue;
+                    e.accessed = false;
+                    young(p.first, d << 10 | i, (u64)e.frame_number);
+                }
+            }
+        }
+    }
+
+    // Directory entry, then the PTE if its table exists (4-byte entries)
+    template <class F>
+    void walk_refs(u64 pid, u64 vpn, F ref) {
+        PageDirectory* dir = procs.find(pid);
+        if (dir == nullptr || vpn >= max_pages()) return;
+        u64 d = vpn >> 10;
+        ref(0, d * 4);
+        if (dir->tables[d] != nullptr) ref(d + 1, (vpn & 0x3FF) * 4);
+    }
+
+    bool clear_accessed(u64 pid, u64 vpn) {
+        PageDirectory* dir = procs.find(pid);
+        if (dir == nullptr || vpn >= max_pages()) return false;
+        PageTableEntry* pte = PD_Lookup(dir, (uint32_t)(vpn << 12));
+        if (pte == nullptr || !pte->valid || !pte->accessed) return false;
+        pte->accessed = false;
+        return true;
+    }
+};
+
+/* ---------------------------------------------------
+   Four-Level: 64-bit radix tree per process (M5)    */
+struct FourLevelBackend {
+    static const char* name() { return "4level"; }
+    static u64 max_pages() { return 1ULL << 36; }
+    bool in_range(u64 vpn) const { return vpn < max_pages(); }
+
+    ProcessTables<PageTreeV2> procs;
+
+    FourLevelBackend(u64, u64) {}
+    ~FourLevelBackend() {
+        for (auto& p : procs.by_pid) {
+            Free_SubtreeV2(p.second->root, 0);
+            delete p.second;
+        }
+    }
+
+    inline long long lookup(u64 pid, u64 vpn) {
+        PageTreeV2* tree = procs.find(pid);
+        if (tree == nullptr) return -1;
+        PageTableEntryV2* leaf = Lookup_PTE_V2(tree, vpn << 12);
+        if (leaf == nullptr) return -1;
+        leaf->accessed = true;
+        return (long long)leaf->frame_number;
+    }
+    inline long long peek(u64 pid, u64 vpn) {
+        PageTreeV2* tree = procs.find(pid);
+        if (tree == nullptr) return -1;
+        PageTableEntryV2* leaf = Lookup_PTE_V2(tree, vpn << 12);
+        return leaf ? (long long)leaf->frame_number : -1;
+    }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        if (vpn >= max_pages()) return false;
+        Map_PageV2(procs.get(pid, [] { return new PageTreeV2(); }), vpn << 12, pfn);
+        return true;
+    }
+    inline long long unmap(u64 pid, u64 vpn) {
+        PageTreeV2* tree = procs.find(pid);
+        return tree ? Unmap_PageV2(tree, vpn << 12) : -1;
+    }
+    u64 table_bytes() const {
+        u64 bytes = 0;
+        for (auto& p : procs.by_pid) bytes += Tree_BytesV2(p.second);
+        return bytes;
+    }
+
+    template <class F>
+    void age_walk(F young, u64* tables, u64* ptes) {
+        for (auto& p : procs.by_pid) age_table(p.first, p.second->root, 0, 0, young, tables, ptes);
+    }
+
+    // One 8-byte entry per level until the leaf or an invalid entry; a
+    // table is named by its level and the VA bits above it
+    template <class F>
+    void walk_refs(u64 pid, u64 vpn, F ref) {
+        PageTreeV2* tree = procs.find(pid);
+        if (tree == nullptr) return;
+        const u64 va = vpn << 12;
+        PageTableV2* table = tree->root;
+        for (int i = 0; i < LEVELS; ++i) {
+            u64 index = get_indexV2(va, i);
+            ref((va >> SHIFT_ARR[i] >> 9) << 2 | (u64)i, index * 8);
+            const PageTableEntryV2& e = table->entries[index];
+            if (!e.is_valid || i == LEVELS - 1) return;
+            table = e.next_level_page_table;
+        }
+    }
+
+    bool clear_accessed(u64 pid, u64 vpn) {
+        PageTreeV2* tree = procs.find(pid);
+        if (tree == nullptr) return false;
+        PageTableEntryV2* leaf = Lookup_PTE_V2(tree, vpn << 12);
+        if (leaf == nullptr || !leaf->accessed) return false;
+        leaf->accessed = false;
+        return true;
+    }
+
+private:
+    template <class F>
+    static void age_table(u64 pid, PageTableV2* table, int level, u64 vpn, F& young, u64* tables, u64* ptes) {
+        (*tables)++;
+        *ptes += ENTRIES_PER_TABLE;
+        for (u64 i = 0; i < ENTRIES_PER_TABLE; ++i) {
+            PageTableEntryV2& e = table->entries[i];
+            if (!e.is_valid) continue;
+            u64 v = vpn << 9 | i;
+            if (level < LEVELS - 1) {
+                age_table(pid, e.next_level_page_table, level + 1, v, young, tables, ptes);
+            } else if (e.accessed) {
+                e.accessed = false;
+                young(pid, v, (u64)e.frame_number);
+            }
+        }
+    }
+};
+
+/* ---------------------------------------------------
+   Adaptive: 64-bit radix tree with nodes sized by
+   population (adaptive_table.h)                     */
+struct AdaptiveBackend {
+    static const char* name() { return "adaptive"; }
+    static u64 max_pages() { return 1ULL << 36; }
+    bool in_range(u64 vpn) const { return vpn < max_pages(); }
+
+    ProcessTables<AdaptiveTree> procs;
+
+    AdaptiveBackend(u64, u64) {}
+    ~AdaptiveBackend() {
+        for (auto& p : procs.by_pid) {
+            if (p.second->root) Art_Free_Subtree(p.second, p.second->root);
+            delete p.second;
+        }
+    }
+
+    inline long long lookup(u64 pid, u64 vpn) {
+        AdaptiveTree* tree = procs.find(pid);
+        return tree ? Art_Lookup(tree, vpn) : -1;
+    }
+    inline long long peek(u64 pid, u64 vpn) { return lookup(pid, vpn); }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        if (vpn >= max_pages()) return false;
+        Art_Map(procs.get(pid, [] { return new AdaptiveTree(); }), vpn, pfn);
+        return true;
+    }
+    inline long long unmap(u64 pid, u64 vpn) {
+        AdaptiveTree* tree = procs.find(pid);
+        return tree ? Art_Unmap(tree, vpn) : -1;
+    }
+    u64 table_bytes() const {
+        u64 bytes = 0;
+        for (auto& p : procs.by_pid) bytes += Art_Bytes(p.second);
+        return bytes;
+    }
+};
+
+/* ---------------------------------------------------
+   Inverted: one (PID, VPN) hash table for the whole machine (M6).
+   Sized by physical memory: one bucket per frame.   */
+struct InvertedBackend {
+    static const char* name() { return "inverted"; }
+    static u64 max_pages() { return 1ULL << 36; }
+    bool in_range(u64 vpn) const { return vpn < max_pages(); }
+
+    HashTable ipt;
+
+    InvertedBackend(u64, u64 frames) : ipt(frames) {}
+
+    inline long long lookup(u64 pid, u64 vpn) {
+        Node* n = IPT_Lookup(&ipt, pid, vpn);
+        return n ? (long long)n->PFN : -1;
+    }
+    inline long long peek(u64 pid, u64 vpn) { return lookup(pid, vpn); }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        insert_node(&ipt, pid, vpn, pfn);
+        return true;
+    }
+    inline long long unmap(u64 pid, u64 vpn) { return remove_node(&ipt, pid, vpn); }
+    u64 table_bytes() const { return IPT_Bytes(&ipt); }
+};
+
+/* ---------------------------------------------------
+   Clustered: one (PID, VPN block) hash table for the whole machine,
+   16 PTEs per bucket (clustered_table.h). Starts sized for dense
+   memory (one cluster per 16 frames, half full) and grows.  */
+struct ClusteredBackend {
+    static const char* name() { return "clustered"; }
+    static u64 max_pages() { return 1ULL << 36; }
+    bool in_range(u64 vpn) const { return vpn < max_pages(); }
+
+    ClusteredTable cpt;
+
+    ClusteredBackend(u64, u64 frames) : cpt(frames / 8) {}
+
+    inline long long lookup(u64 pid, u64 vpn) { return CPT_Lookup(&cpt, pid, vpn); }
+    inline long long peek(u64 pid, u64 vpn) { return lookup(pid, vpn); }
+    inline bool map(u64 pid, u64 vpn, u64 pfn) {
+        CPT_Map(&cpt, pid, vpn, pfn);
+        return true;
+    }
+    inline long long unmap(u64 pid, u64 vpn) { return CPT_Unmap(&cpt, pid, vpn); }
+    u64 table_bytes() const { return CPT_Bytes(&cpt); }
+};
+
+#endif
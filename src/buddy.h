@@ -0,0 +1,162 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Binary Buddy Allocator
+   ===================================================
+   Hands out blocks of 2^order physically contiguous frames, aligned to
+   their size (huge pages, DMA buffers), or single frames in place of
+   the milestone freeList. One free list per order:
+
+     alloc(k)  take a block from the smallest non-empty order >= k and
+               split it, returning the upper halves to the lower lists
+     free(k)   while the block's buddy (frame ^ 2^k) is a free block of
+               the same order, merge the two and go up one order
+
+   The lists are intrusive and doubly linked over frame numbers, so a
+   buddy is unlinked in O(1). A frame count that is not a power of two
+   is seeded as the largest aligned blocks that fit.
+
+   Fragmentation index (as in Linux): for an order with no free block
+   big enough, how much a failure is due to fragmentation (-> 1) rather
+   than lack of memory (-> 0); -1 when a request would succeed.        */
+
+const int BUDDY_MAX_ORDER = 10; // 1024 frames: 4 MiB with 4 KiB pages
+const uint32_t BUDDY_NIL = 0xFFFFFFFFu;
+
+struct BuddyAllocator {
+    u64 total = 0;
+    std::vector<uint32_t> next, prev; // Free-list links, valid at block heads
+    std::vector<int8_t> free_order;   // Order of the free block headed here; -1 otherwise
+    uint32_t head[BUDDY_MAX_ORDER + 1];
+    u64 free_blocks[BUDDY_MAX_ORDER + 1];
+    u64 free_pages = 0;
+    u64 splits = 0;
+    u64 merges = 0;
+    u64 failures = 0;
+};
+
+inline void Buddy_Push(BuddyAllocator* b, u64 frame, int order) {
+    uint32_t f = (uint32_t)frame;
+    b->prev[f] = BUDDY_NIL;
+    b->next[f] = b->head[order];
+    if (b->head[order] != BUDDY_NIL) b->prev[b->head[order]] = f;
+    b->head[order] = f;
+    b->free_order[f] = (int8_t)order;
+    b->free_blocks[order]++;
+    b->free_pages += 1ULL << order;
+}
+
+inline void Buddy_Unlink(BuddyAllocator* b, u64 frame) {
+    uint32_t f = (uint32_t)frame;
+    int order = b->free_order[f];
+    if (b->prev[f] != BUDDY_NIL) b->next[b->prev[f]] = b->next[f]; else b->head[order] = b->next[f];
+    if (b->next[f] != BUDDY_NIL) b->prev[b->next[f]] = b->prev[f];
+    b->free_order[f] = -1;
+    b->free_blocks[order]--;
+    b->free_pages -= 1ULL << order;
+}
+
+inline void Buddy_Init(BuddyAllocator* b, u64 total_frames) {
+    b->total = total_frames;
+    b->next.assign(total_frames, BUDDY_NIL);
+    b->prev.assign(total_frames, BUDDY_NIL);
+    b->free_order.assign(total_frames, -1);
+    for (int k = 0; k <= BUDDY_MAX_ORDER; ++k) {
+        b->head[k] = BUDDY_NIL;
+        b->free_blocks[k] = 0;
+    }
+    b->free_pages = b->splits = b->merges = b->failures = 0;
+    // Seed from the top so the lowest blocks end up at the list heads
+    std::vector<std::pair<u64, int>> blocks;
+    for (u64 f = 0; f < total_frames;) {
+        int k = BUDDY_MAX_ORDER;
+        while (k > 0 && ((f & ((1ULL << k) - 1)) != 0 || f + (1ULL << k) > total_frames)) k--;
+        blocks.push_back({f, k});
+        f += 1ULL << k;
+    }
+    for (std::size_t i = blocks.size(); i > 0; --i) Buddy_Push(b, blocks[i - 1].first, blocks[i - 1].second);
+}
+
+// First frame of a free 2^order block, or -1
+inline long long Buddy_Alloc(BuddyAllocator* b, int order) {
+    if (order < 0 || order > BUDDY_MAX_ORDER) return -1;
+    int k = order;
+    while (k <= BUDDY_MAX_ORDER && b->head[k] == BUDDY_NIL) k++;
+    if (k > BUDDY_MAX_ORDER) {
+        b->failures++;
+        return -1;
+    }
+    u64 frame = b->head[k];
+    Buddy_Unlink(b, frame);
+    while (k > order) {
+        k--;
+        Buddy_Push(b, frame + (1ULL << k), k); // Upper half goes back, keep the lower
+        b->splits++;
+    }
+    return (long long)frame;
+}
+
+// Returns a block from Buddy_Alloc(order), merging it with free buddies
+inline void Buddy_Free(BuddyAllocator* b, u64 frame, int order) {
+    if (frame >= b->total || b->free_order[frame] >= 0) return; // Double free
+    while (order < BUDDY_MAX_ORDER) {
+        u64 buddy = frame ^ (1ULL << order);
+        if (buddy >= b->total || b->free_order[buddy] != order) break;
+        Buddy_Unlink(b, buddy);
+        if (buddy < frame) frame = buddy;
+        order++;
+        b->merges++;
+    }
+    Buddy_Push(b, frame, order);
+}
+
+// Smallest order whose block holds `pages` frames
+inline int Buddy_Order_For(u64 pages) {
+    int k = 0;
+    while ((1ULL << k) < pages) k++;
+    return k;
+}
+
+// Fragmentation index of `order`, in [0, 1], or -1 if it would succeed
+inline double Buddy_Fragmentation_Index(const BuddyAllocator* b, int order) {
+    u64 total_blocks = 0, suitable = 0;
+    for (int k = 0; k <= BUDDY_MAX_ORDER; ++k) {
+        total_blocks += b->free_blocks[k];
+        if (k >= order) suitable += b->free_blocks[k];
+    }
+    if (total_blocks == 0) return 0.0;
+    if (suitable > 0) return -1.0;
+    double requested = (double)(1ULL << order);
+    return 1.0 - (1.0 + b->free_pages / requested) / total_blocks;
+}
+
+// --- Drop-in for the freeList interface (single frames) ---
+inline long long allocate_frame(BuddyAllocator* b) { return Buddy_Alloc(b, 0); }
+inline void free_frame(BuddyAllocator* b, int frameNumber) { Buddy_Free(b, (u64)frameNumber, 0); }
+
+// buddyinfo-style summary: free blocks per order, fragmentation per order
+inline void Buddy_Print(const BuddyAllocator* b, std::ostream& out) {
+    int top = 0;
+    while ((1ULL << (top + 1)) <= b->total && top < BUDDY_MAX_ORDER) top++;
+    out << "   [BUDDY] Free: " << b->free_pages << "/" << b->total << " frames | Blocks by order:";
+    for (int k = 0; k <= top; ++k) out << " " << b->free_blocks[k];
+    out << " | Splits: " << b->splits << " Merges: " << b->merges << "\n";
+    out << "   [BUDDY] Fragmentation index by order:";
+    for (int k = 0; k <= top; ++k) {
+        double fi = Buddy_Fragmentation_Index(b, k);
+        if (fi < 0) out << " -";
+        else out << " " << std::fixed << std::setprecision(2) << fi << std::defaultfloat;
+    }
+    out << "\n";
+}
+
+#endif
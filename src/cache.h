@@ -0,0 +1,186 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Data Cache Hierarchy
+   ===================================================
+   Up to CACHE_MAX_LEVELS set-associative LRU caches in front of
+   memory, nearest first; the last one is the LLC. Every level
+   allocates on a miss and nothing is back-invalidated (mostly
+   inclusive), so an access served by level k also fills the levels
+   above it.
+
+   The MMU feeds two kinds of reference:
+     data   the physical address of every translated access
+     walk   every page-table entry the hardware walker loads on a TLB
+            miss, root first, down to the leaf or the first invalid
+            entry (backends with walk_refs(), see backends.h)
+
+   Page tables live in the simulator's heap, not in frames, so each
+   table is given a physical page of its own: a hash of (PID, table)
+   into a region above any frame address (CACHE_TABLE_SPACE), with
+   entries at their hardware size. The placement is deterministic, so
+   runs repeat exactly.
+
+   Each line remembers which kind filled it. Per level the model keeps
+   misses by kind, the lines holding PTEs now and on average, and the
+   data lines evicted to make room for PTEs: what page tables take from
+   data, most of all in the LLC.                                        */
+
+enum CacheRefKind { CACHE_DATA, CACHE_WALK, CACHE_KINDS };
+
+const int CACHE_MAX_LEVELS = 3;
+const u64 CACHE_TABLE_SPACE = 1ULL << 62;
+
+struct CacheGeometry {
+    u64 kib;
+    u64 ways;
+};
+
+struct CacheLevelStats {
+    u64 accesses[CACHE_KINDS] = {0, 0};
+    u64 misses[CACHE_KINDS] = {0, 0};
+    u64 stolen = 0;        // Data lines evicted by PTE fills
+    u64 walk_line_sum = 0; // PTE lines held, summed over every reference
+};
+
+struct CacheLevel {
+    u64 sets = 0;
+    u64 ways = 0;
+    std::vector<u64> tags;     // sets x ways: line address + 1, 0 = empty
+    std::vector<u64> used;     // Last use on the hierarchy clock (LRU)
+    std::vector<uint8_t> kind; // CacheRefKind that filled the line
+    u64 walk_lines = 0;        // Lines holding PTEs now
+    CacheLevelStats stats;
+
+    u64 lines() const { return sets * ways; }
+
+    // True on a hit; a miss fills the least recently used way
+    inline bool access(u64 line, int k, u64 now) {
+        const u64 base = (line & (sets - 1)) * ways;
+        stats.accesses[k]++;
+        u64 victim = base;
+        for (u64 w = base; w < base + ways; ++w) {
+            if (tags[w] == line + 1) {
+                used[w] = now;
+                return true;
+            }
+            if (used[w] < used[victim]) victim = w; // Empty ways have used 0
+        }
+        stats.misses[k]++;
+        if (tags[victim] != 0) {
+            if (kind[victim] == CACHE_WALK) walk_lines--;
+            else if (k == CACHE_WALK) stats.stolen++;
+        }
+        walk_lines += k == CACHE_WALK;
+        tags[victim] = line + 1;
+        used[victim] = now;
+        kind[victim] = (uint8_t)k;
+        return false;
+    }
+};
+
+struct CacheHierarchy {
+    std::vector<CacheLevel> levels; // Empty = no cache model
+    u64 line_shift = 6;
+    u64 clock = 0;
+    u64 walks = 0; // TLB misses whose PTE loads were fed in
+
+    bool enabled() const { return !levels.empty(); }
+    u64 line_bytes() const { return 1ULL << line_shift; }
+
+    // Index of the level that served the reference; levels.size() = memory
+    inline u64 access(u64 pa, int k) {
+        const u64 line = pa >> line_shift;
+        clock++;
+        u64 served = levels.size();
+        for (u64 i = 0; i < levels.size(); ++i) {
+            if (levels[i].access(line, k, clock)) {
+                served = i;
+                break;
+            }
+        }
+        for (CacheLevel& l : levels) l.stats.walk_line_sum += l.walk_lines;
+        return served;
+    }
+};
+
+// False unless every level has a power-of-two number of sets
+inline bool Cache_Init(CacheHierarchy* h, const std::vector<CacheGeometry>& geometry, u64 line_bytes = 64) {
+    if (line_bytes < 8 || (line_bytes & (line_bytes - 1)) || geometry.size() > (std::size_t)CACHE_MAX_LEVELS) {
+        return false;
+    }
+    h->levels.assign(geometry.size(), CacheLevel());
+    h->line_shift = 0;
+    while ((1ULL << h->line_shift) < line_bytes) h->line_shift++;
+    h->clock = 0;
+    h->walks = 0;
+    for (std::size_t i = 0; i < geometry.size(); ++i) {
+        CacheLevel& l = h->levels[i];
+        u64 lines = (geometry[i].kib << 10) / line_bytes;
+        if (geometry[i].ways == 0 || lines % geometry[i].ways != 0) return false;
+        l.ways = geometry[i].ways;
+        l.sets = lines / l.ways;
+        if (l.sets == 0 || (l.sets & (l.sets - 1))) return false;
+        l.tags.assign(lines, 0);
+        l.used.assign(lines, 0);
+        l.kind.assign(lines, CACHE_DATA);
+    }
+    return true;
+}
+
+// "L1", "L2", ... with the last level called "LLC"
+inline std::string Cache_Level_Name(u64 level, u64 levels) {
+    return level + 1 == levels ? "LLC" : "L" + std::to_string(level + 1);
+}
+
+// Physical address of byte `offset` of a process's page table `table`
+// (a backend-chosen id, unique within the process)
+inline u64 Cache_Table_Address(u64 pid, u64 table, u64 offset) {
+    u64 x = (pid * 0x9E3779B97F4A7C15ULL) ^ table;
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 29;
+    return CACHE_TABLE_SPACE | (x & ((1ULL << 40) - 1)) << 12 | offset;
+}
+
+// "KIB:WAYS,..." nearest level first, e.g. 32:8,1024:16,8192:16
+inline bool Parse_Caches(const std::string& spec, std::vector<CacheGeometry>* geometry) {
+    geometry->clear();
+    std::size_t at = 0;
+    while (at < spec.size()) {
+        std::size_t end = spec.find(',', at);
+        if (end == std::string::npos) end = spec.size();
+        unsigned long long kib, ways;
+        char tail;
+        if (std::sscanf(spec.substr(at, end - at).c_str(), "%llu:%llu%c", &kib, &ways, &tail) != 2 || kib == 0 ||
+            ways == 0) {
+            return false;
+        }
+        geometry->push_back({kib, ways});
+        at = end + 1;
+    }
+    return !geometry->empty() && geometry->size() <= (std::size_t)CACHE_MAX_LEVELS;
+}
+
+// Backends whose walks can be replayed through the caches provide
+// walk_refs(pid, vpn, ref), calling ref(table, offset) per PTE load
+struct Cache_No_Ref {
+    void operator()(u64, u64) const {}
+};
+template <class B, class = void>
+struct Has_Walk_Refs : std::false_type {};
+template <class B>
+struct Has_Walk_Refs<B, decltype(std::declval<B&>().walk_refs((u64)0, (u64)0, Cache_No_Ref()))>
+    : std::true_type {};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef CLUSTERED_TABLE_H
+#define CLUSTERED_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t u64;
+
+// --- Clustered Page Table: one hash table for all processes ---
+// Keyed by (PID, VPN block); each bucket *is* a cluster holding the
+// PTEs of 16 consecutive pages, so a dense region translates with a
+// single probe into one array and pays one tag per 16 pages.
+// Open addressing with linear probing; the array doubles past half
+// full and deletion shifts entries back (no tombstones).
+
+const int CLUSTER_SHIFT = 4;
+const int CLUSTER_PAGES = 1 << CLUSTER_SHIFT;
+
+struct PteCluster {
+    u64 PID;
+    u64 block;                    // VPN >> CLUSTER_SHIFT
+    uint32_t valid;               // Bit i: page (block << 4) + i is mapped; 0 = empty bucket
+    uint32_t PFN[CLUSTER_PAGES];  // Frames fit the frame manager's 32-bit indices
+};
+
+struct ClusteredTable {
+    std::vector<PteCluster> buckets;
+    u64 mask;
+    u64 num_clusters = 0;
+    u64 num_pages = 0;
+
+    // Power-of-two bucket count, at least `min_buckets`
+    explicit ClusteredTable(u64 min_buckets) {
+        u64 n = 16;
+        while (n < min_buckets) n <<= 1;
+        buckets.assign(n, PteCluster());
+        mask = n - 1;
+    }
+};
+
+inline u64 CPT_Hash(u64 PID, u64 block) {
+    // Multiplicative mix: neighbouring blocks land in different buckets
+    return ((block ^ (PID << 48) ^ (PID >> 16)) * 0x9E3779B97F4A7C15ULL) >> 20;
+}
+
+// Bucket holding (PID, block), or the empty bucket where it would go
+inline u64 CPT_Probe(const ClusteredTable* cpt, u64 PID, u64 block) {
+    u64 i = CPT_Hash(PID, block) & cpt->mask;
+    while (true) {
+        const PteCluster& c = cpt->buckets[i];
+        if (c.valid == 0 || (c.block == block && c.PID == PID)) return i;
+        i = (i + 1) & cpt->mask;
+    }
+}
+
+// Frame of (PID, VPN), or -1
+inline long long CPT_Lookup(const ClusteredTable* cpt, u64 PID, u64 VPN) {
+    const PteCluster& c = cpt->buckets[CPT_Probe(cpt, PID, VPN >> CLUSTER_SHIFT)];
+    u64 i = VPN & (CLUSTER_PAGES - 1);
+    return (c.valid >> i & 1) ? (long long)c.PFN[i] : -1;
+}
+
+inline void CPT_Grow(ClusteredTable* cpt) {
+    std::vector<PteCluster> old;
+    old.swap(cpt->buckets);
+    cpt->buckets.assign(old.size() * 2, PteCluster());
+    cpt->mask = cpt->buckets.size() - 1;
+    for (const PteCluster& c : old) {
+        if (c.valid != 0) cpt->buckets[CPT_Probe(cpt, c.PID, c.block)] = c;
+    }
+}
+
+inline void CPT_Map(ClusteredTable* cpt, u64 PID, u64 VPN, u64 PFN) {
+    u64 block = VPN >> CLUSTER_SHIFT;
+    u64 i = VPN & (CLUSTER_PAGES - 1);
+    u64 b = CPT_Probe(cpt, PID, block);
+    if (cpt->buckets[b].valid == 0) {
+        // New cluster; keep the load factor at or below 1/2
+        if ((cpt->num_clusters + 1) * 2 > cpt->buckets.size()) {
+            CPT_Grow(cpt);
+            b = CPT_Probe(cpt, PID, block);
+        }
+        cpt->buckets[b].PID = PID;
+        cpt->buckets[b].block = block;
+        cpt->num_clusters++;
+    }
+    PteCluster& c = cpt->buckets[b];
+    if (!(c.valid >> i & 1)) cpt->num_pages++;
+    c.valid |= 1u << i;
+    c.PFN[i] = (uint32_t)PFN;
+}
+
+// Clears (PID, VPN); empties the bucket once its last page is gone.
+// Returns the old frame, or -1 if it was not mapped.
+inline long long CPT_Unmap(ClusteredTable* cpt, u64 PID, u64 VPN) {
+    u64 i = VPN & (CLUSTER_PAGES - 1);
+    u64 hole = CPT_Probe(cpt, PID, VPN >> CLUSTER_SHIFT);
+    PteCluster& c = cpt->buckets[hole];
+    if (!(c.valid >> i & 1)) return -1;
+
+    long long pfn = c.PFN[i];
+    c.valid &= ~(1u << i);
+    cpt->num_pages--;
+    if (c.valid != 0) return pfn;
+    cpt->num_clusters--;
+
+    // Backward shift: pull later entries of the run into the hole unless
+    // their home bucket lies cyclically in (hole, j]
+    for (u64 j = (hole + 1) & cpt->mask; cpt->buckets[j].valid != 0; j = (j + 1) & cpt->mask) {
+        u64 home = CPT_Hash(cpt->buckets[j].PID, cpt->buckets[j].block) & cpt->mask;
+        if (((j - home) & cpt->mask) < ((j - hole) & cpt->mask)) continue;
+        cpt->buckets[hole] = cpt->buckets[j];
+        cpt->buckets[j].valid = 0;
+        hole = j;
+    }
+    return pfn;
+}
+
+inline u64 CPT_Bytes(const ClusteredTable* cpt) {
+    return cpt->buckets.size() * sizeof(PteCluster);
+}
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef FRAME_ALLOC_H
+#define FRAME_ALLOC_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Free Frame Stack (the milestone allocator)
+   =================================================== */
+typedef struct {
+    std::vector<int> fram;
+    int top;
+} freeList;
+
+inline void init_free_list(freeList* list, int total_frames) {
+    list->fram.assign(total_frames, 0);
+    list->top = -1;
+    for (int i = 0; i < total_frames; ++i) {
+        list->top++;
+        list->fram[list->top] = i;
+    }
+}
+
+// Remove from "Free" list (Pop)
+inline long long allocate_frame(freeList* list) {
+    if (list->top == -1) return -1;
+    int allocated_frame = list->fram[list->top];
+    list->top--;
+    return allocated_frame;
+}
+
+// Free = Add to "Free" list (Push)
+inline void free_frame(freeList* list, int frameNumber) {
+    if (list->top == (int)list->fram.size() - 1) return;
+    list->top++;
+    list->fram[list->top] = frameNumber;
+}
+
+/* ===================================================
+   Replacement Policies
+   ===================================================
+   A policy tracks resident frames and picks victims. Every call is
+   made by FrameManager:
+     init(n)                      once, with the number of frames
+     on_insert(frame, pid, vpn)   frame was just filled (that fault is
+                                  the page's first reference)
+     on_access(frame)             frame was referenced again
+     on_remove(frame)             frame was freed without eviction
+     on_move(from, to)            the page in `from` moved to the free
+                                  frame `to`, keeping its recency
+     victim()                     choose a frame to evict and stop
+                                  tracking it; on_insert follows
+   and, for the tiering daemon's demotion scan:
+     coldest(), warmer(frame)     walk resident frames from the victim
+                                  end (NIL past the last)
+   Scan-resistant alternatives (ARC, 2Q, LIRS) are in replacement.h. */
+
+// Exact LRU as an intrusive doubly linked list over frame numbers: O(1)
+struct LruPolicy {
+    static const char* name() { return "lru"; }
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    std::vector<uint32_t> prev, next;
+    uint32_t head = NIL; // Most recently used
+    uint32_t tail = NIL; // Least recently used
+
+    void init(u64 n) {
+        prev.assign(n, NIL);
+        next.assign(n, NIL);
+    }
+
+    inline void on_insert(u64 frame, u64, u64) { push_front((uint32_t)frame); }
+
+    inline void on_access(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (head == f) return;
+        unlink(f);
+        push_front(f);
+    }
+
+    inline void on_remove(u64 frame) { unlink((uint32_t)frame); }
+
+    inline u64 victim() {
+        uint32_t v = tail;
+        unlink(v);
+        return v;
+    }
+
+    inline u64 coldest() const { return tail; }
+    inline u64 warmer(u64 frame) const { return prev[frame]; }
+
+    inline void on_move(u64 from, u64 to) {
+        uint32_t f = (uint32_t)from, t = (uint32_t)to;
+        prev[t] = prev[f];
+        next[t] = next[f];
+        if (prev[t] != NIL) next[prev[t]] = t; else head = t;
+        if (next[t] != NIL) prev[next[t]] = t; else tail = t;
+        prev[f] = next[f] = NIL;
+    }
+
+private:
+    inline void push_front(uint32_t f) {
+        prev[f] = NIL;
+        next[f] = head;
+        if (head != NIL) prev[head] = f;
+        head = f;
+        if (tail == NIL) tail = f;
+    }
+
+    inline void unlink(uint32_t f) {
+        if (prev[f] != NIL) next[prev[f]] = next[f]; else head = next[f];
+        if (next[f] != NIL) prev[next[f]] = prev[f]; else tail = prev[f];
+        prev[f] = next[f] = NIL;
+    }
+};
+
+/* ===================================================
+   Frame Manager: frame table + free stacks + policy
+   ===================================================
+   Physical memory may be split into nodes (NUMA nodes or memory
+   tiers, see tiering.h): node n owns a contiguous frame range and has
+   its own free stack. allocate() takes a free frame from the preferred
+   node, else from the following ones; only when every node is full
+   does the policy pick a victim. One node by default.                 */
+
+struct FrameInfo {
+    u64 pid = 0;
+    u64 vpn = 0;       // Reverse map: which page owns this frame
+    uint32_t refs = 0; // Mappings of the frame; > 1 = shared copy-on-write
+    bool in_use = false;
+    bool dirty = false;
+    bool prefetched = false; // Brought in speculatively, not yet accessed
+};
+
+// A further (PID, VPN) mapping of a shared frame
+struct FrameMapping {
+    u64 pid;
+    u64 vpn;
+};
+
+// Filled in by allocate() when it had to evict
+struct Victim {
+    bool valid = false;
+    u64 frame = 0;
+    u64 pid = 0;
+    u64 vpn = 0;
+    bool dirty = false;
+    bool prefetched = false;            // Evicted without ever being accessed
+    std::vector<FrameMapping> sharers;  // Other mappings of a shared frame
+};
+
+template <class Policy = LruPolicy>
+struct FrameManager {
+    std::vector<FrameInfo> frames;
+    std::vector<std::vector<uint32_t>> free_stacks; // Per node
+    std::vector<u64> node_base;                     // Node n: [node_base[n], node_base[n + 1])
+    std::vector<uint8_t> node_of;                   // Per frame
+    u64 free_frames = 0;
+    Policy policy;
+    // Reverse map beyond FrameInfo's (pid, vpn): frame -> other mappings
+    std::unordered_map<u64, std::vector<FrameMapping>> sharers;
+
+    explicit FrameManager(u64 num_frames) : frames(num_frames) {
+        set_nodes(std::vector<u64>(1, num_frames));
+        policy.init(num_frames);
+    }
+
+    // Splits the frames into nodes of these sizes (at most 255, summing
+    // to the capacity) and frees them all; only valid before first use
+    void set_nodes(const std::vector<u64>& sizes) {
+        free_stacks.assign(sizes.size(), std::vector<uint32_t>());
+        node_base.assign(1, 0);
+        node_of.assign(frames.size(), 0);
+        for (std::size_t n = 0; n < sizes.size(); ++n) {
+            u64 base = node_base.back(), end = base + sizes[n];
+            // Pop order base, base + 1, ...: consecutive faults get consecutive frames
+            free_stacks[n].reserve(sizes[n]);
+            for (u64 i = end; i > base; --i) free_stacks[n].push_back((uint32_t)(i - 1));
+            for (u64 i = base; i < end; ++i) node_of[i] = (uint8_t)n;
+            node_base.push_back(end);
+        }
+        free_frames = frames.size();
+    }
+
+    u64 capacity() const { return frames.size(); }
+    u64 used() const { return frames.size() - free_frames; }
+    u64 nodes() const { return free_stacks.size(); }
+    u64 node_frames(u64 node) const { return node_base[node + 1] - node_base[node]; }
+    u64 node_free(u64 node) const { return free_stacks[node].size(); }
+
+    // Always succeeds while capacity > 0; reports the evicted page, if any.
+    inline u64 allocate(u64 pid, u64 vpn, Victim* evicted, u64 node = 0) {
+        u64 frame;
+        evicted->valid = false;
+        if (free_frames != 0) {
+            frame = pop_free(node);
+        } else {
+            frame = policy.victim();
+            FrameInfo& old = frames[frame];
+            evicted->valid = true;
+            evicted->frame = frame;
+            evicted->pid = old.pid;
+            evicted->vpn = old.vpn;
+            evicted->dirty = old.dirty;
+            evicted->prefetched = old.prefetched;
+            if (old.refs > 1) take_sharers(frame, &evicted->sharers);
+        }
+        FrameInfo& f = frames[frame];
+        f.pid = pid;
+        f.vpn = vpn;
+        f.refs = 1;
+        f.in_use = true;
+        f.dirty = false;
+        f.prefetched = false;
+        policy.on_insert(frame, pid, vpn);
+        return frame;
+    }
+
+    // True on the first access to a prefetched frame
+    inline bool touch(u64 frame, bool write) {
+        FrameInfo& f = frames[frame];
+        f.dirty |= write;
+        policy.on_access(frame);
+        if (!f.prefetched) return false;
+        f.prefetched = false;
+        return true;
+    }
+
+    inline void release(u64 frame) {
+        if (!frames[frame].in_use) return;
+        if (frames[frame].refs > 1) sharers.erase(frame);
+        frames[frame].refs = 0;
+        frames[frame].in_use = false;
+        policy.on_remove(frame);
+        free_stacks[node_of[frame]].push_back((uint32_t)frame);
+        free_frames++;
+    }
+
+    // Moves the page in `frame` to a free frame on `node`, with its
+    // sharers and recency; the old frame is freed. Returns the new
+    // frame, or -1 if that node has none free. The caller remaps.
+    long long migrate(u64 frame, u64 node) {
+        if (!frames[frame].in_use || free_stacks[node].empty()) return -1;
+        u64 to = free_stacks[node].back();
+        free_stacks[node].pop_back();
+        frames[to] = frames[frame];
+        auto it = sharers.find(frame);
+        if (it != sharers.end()) {
+            std::vector<FrameMapping> more;
+            more.swap(it->second);
+            sharers.erase(it);
+            sharers[to].swap(more);
+        }
+        policy.on_move(frame, to);
+        frames[frame].refs = 0;
+        frames[frame].in_use = false;
+        free_stacks[node_of[frame]].push_back((uint32_t)frame);
+        return (long long)to;
+    }
+
+    // Adds one more mapping of an in-use frame (fork)
+    void share(u64 frame, u64 pid, u64 vpn) {
+        frames[frame].refs++;
+        sharers[frame].push_back({pid, vpn});
+    }
+
+    // Drops one mapping of a shared frame. False if it was the only one
+    // (nothing changes; the caller releases the frame).
+    bool unshare(u64 frame, u64 pid, u64 vpn) {
+        FrameInfo& f = frames[frame];
+        if (f.refs <= 1) return false;
+        std::vector<FrameMapping>& more = sharers[frame];
+        if (f.pid == pid && f.vpn == vpn) {
+            // The owner leaves: promote the latest sharer
+            f.pid = more.back().pid;
+            f.vpn = more.back().vpn;
+            more.pop_back();
+        } else {
+            for (std::size_t i = 0; i < more.size(); ++i) {
+                if (more[i].pid != pid || more[i].vpn != vpn) continue;
+                more[i] = more.back();
+                more.pop_back();
+                break;
+            }
+        }
+        if (more.empty()) sharers.erase(frame);
+        f.refs--;
+        return true;
+    }
+
+    // f(pid, vpn) for every mapping of an in-use frame, owner first
+    template <class F>
+    void for_each_mapping(u64 frame, F f) const {
+        f(frames[frame].pid, frames[frame].vpn);
+        if (frames[frame].refs <= 1) return;
+        auto it = sharers.find(frame);
+        if (it == sharers.end()) return;
+        for (const FrameMapping& m : it->second) f(m.pid, m.vpn);
+    }
+
+    // Page mappings over resident frames (> used() when frames are shared)
+    u64 mappings() const {
+        u64 n = 0;
+        for (const FrameInfo& f : frames) n += f.in_use ? f.refs : 0;
+        return n;
+    }
+
+private:
+    // First free frame on `node` or, failing that, on the nodes after it
+    inline u64 pop_free(u64 node) {
+        for (std::size_t k = 0;; ++k) {
+            std::vector<uint32_t>& stack = free_stacks[(node + k) % free_stacks.size()];
+            if (stack.empty()) continue;
+            u64 frame = stack.back();
+            stack.pop_back();
+            free_frames--;
+            return frame;
+        }
+    }
+
+    void take_sharers(u64 frame, std::vector<FrameMapping>* out) {
+        auto it = sharers.find(frame);
+        if (it == sharers.end()) return;
+        out->swap(it->second);
+        sharers.erase(it);
+    }
+};
+
+#endif
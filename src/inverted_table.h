@@ -0,0 +1,94 @@
+#ifndef INVERTED_TABLE_H
+#define INVERTED_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t u64;
+
+// --- Inverted Page Table: one hash table for all processes ---
+// Keyed by (PID, VPN); collisions chain through a singly linked list.
+
+struct Node {
+    u64 PID;   // Owner Process
+    u64 VPN;   // Virtual Page Number
+    u64 PFN;   // Physical Frame Number
+    Node* next; // Chaining for collisions
+};
+
+struct HashTable {
+    std::vector<Node*> buckets;
+    u64 num_nodes = 0;
+
+    explicit HashTable(u64 num_buckets) : buckets(num_buckets ? num_buckets : 1, nullptr) {}
+
+    ~HashTable() {
+        for (Node* head : buckets) {
+            while (head) { Node* next = head->next; delete head; head = next; }
+        }
+    }
+};
+
+inline u64 Hash_Function(const HashTable* ipt, u64 PID, u64 VPN) {
+    // Simple XOR Hash
+    u64 combined = PID ^ VPN;
+    return combined % ipt->buckets.size();
+}
+
+inline Node* find_node(Node* head, u64 PID, u64 VPN) {
+    Node* current = head;
+    while (current != nullptr) {
+        if (current->PID == PID && current->VPN == VPN) {
+            return current; // Found match
+        }
+        current = current->next;
+    }
+    return nullptr; // Not found
+}
+
+inline Node* IPT_Lookup(const HashTable* ipt, u64 PID, u64 VPN) {
+    return find_node(ipt->buckets[Hash_Function(ipt, PID, VPN)], PID, VPN);
+}
+
+inline void insert_node(HashTable* ipt, u64 PID, u64 VPN, u64 PFN) {
+    u64 idx = Hash_Function(ipt, PID, VPN);
+
+    // Check if update existing
+    Node* existing = find_node(ipt->buckets[idx], PID, VPN);
+    if (existing) {
+        existing->PFN = PFN;
+        return;
+    }
+
+    // Insert New (Head Insertion)
+    Node* new_node = new Node;
+    new_node->PID = PID;
+    new_node->VPN = VPN;
+    new_node->PFN = PFN;
+    new_node->next = ipt->buckets[idx];
+    ipt->buckets[idx] = new_node;
+    ipt->num_nodes++;
+}
+
+// Unlinks (PID, VPN); returns its frame, or -1 if it was not mapped.
+inline long long remove_node(HashTable* ipt, u64 PID, u64 VPN) {
+    Node** link = &ipt->buckets[Hash_Function(ipt, PID, VPN)];
+    while (*link) {
+        Node* current = *link;
+        if (current->PID == PID && current->VPN == VPN) {
+            long long pfn = (long long)current->PFN;
+            *link = current->next;
+            delete current;
+            ipt->num_nodes--;
+            return pfn;
+        }
+        link = &current->next;
+    }
+    return -1;
+}
+
+inline u64 IPT_Bytes(const HashTable* ipt) {
+    return ipt->buckets.size() * sizeof(Node*) + ipt->num_nodes * sizeof(Node);
+}
+
+#endif
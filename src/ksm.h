@@ -0,0 +1,157 @@
+#ifndef KSM_H
+#define KSM_H
+
+#include "frame_alloc.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Same-Page Merging (KSM-style dedup scanner)
+   ===================================================
+   Every `interval` accesses the scanner visits the next `pages` frames
+   (round robin) and hashes their contents:
+
+     - a frame whose checksum changed since its last visit is volatile
+       and skipped this time (only its checksum is recorded);
+     - a stable tree (hash -> merged frame) is searched first, then an
+       unstable tree of candidates seen during the current pass; the
+       unstable tree is dropped at the end of each pass;
+     - a hash match is confirmed with memcmp, then every mapping of the
+       scanned frame is moved onto the match and the frame is freed;
+     - a merged frame takes at most `max_sharing` mappings (unmapping
+       one walks its sharer list); a full one is replaced in the stable
+       tree by the next duplicate, which starts a fresh group.
+
+   Merged frames are ordinary shared frames (refs > 1), so the MMU's
+   copy-on-write path splits them again on the first write. Only
+   meaningful with frame contents modelled (Mmu::enable_data).         */
+
+struct KsmStats {
+    u64 batches = 0;
+    u64 scanned = 0;     // Frames visited
+    u64 hashed = 0;      // Frames whose contents were hashed
+    u64 compared = 0;    // memcmp confirmations
+    u64 merged = 0;      // Frames freed by merging
+    u64 passes = 0;      // Full rounds over physical memory
+    u64 scan_ns = 0;     // Host time spent scanning (the CPU cost)
+};
+
+struct KsmScanner {
+    u64 pages = 0;        // Frames per batch; 0 = off
+    u64 interval = 1000;  // Accesses between batches
+    u64 max_sharing = 256;
+
+    u64 cursor = 0;
+    u64 since = 0;
+    std::vector<u64> checksum;             // Per frame; 0 = not seen yet
+    std::unordered_map<u64, u64> stable;   // Hash -> merged frame
+    std::unordered_map<u64, u64> unstable; // Hash -> candidate (this pass)
+    KsmStats stats;
+
+    bool enabled() const { return pages > 0; }
+
+    inline bool due() {
+        if (++since < interval) return false;
+        since = 0;
+        return true;
+    }
+};
+
+inline u64 Ksm_Hash(const unsigned char* page, u64 bytes) {
+    u64 h = 0xCBF29CE484222325ULL;
+    for (u64 i = 0; i < bytes; i += 8) {
+        u64 w;
+        std::memcpy(&w, page + i, 8);
+        h = (h ^ w) * 0x100000001B3ULL;
+    }
+    return h | 1; // Never 0, which marks "not seen"
+}
+
+// Moves every mapping of `from` onto `into` (identical contents) and frees `from`
+template <class M>
+void Ksm_Merge(M& mmu, u64 from, u64 into) {
+    std::vector<FrameMapping> maps;
+    mmu.frames.for_each_mapping(from, [&](u64 pid, u64 vpn) { maps.push_back({pid, vpn}); });
+    for (const FrameMapping& m : maps) {
+        mmu.table.map(m.pid, m.vpn, into);
+        mmu.tlb.invalidate(m.pid, m.vpn);
+        mmu.frames.share(into, m.pid, m.vpn);
+    }
+    mmu.frames.frames[into].dirty |= mmu.frames.frames[from].dirty;
+    mmu.frames.release(from);
+}
+
+// One batch: visit the next `ksm.pages` frames
+template <class M>
+void Ksm_Scan(M& mmu) {
+    KsmScanner& ksm = mmu.ksm;
+    const u64 n = mmu.frames.capacity();
+    const u64 bytes = mmu.ram.size() / (n ? n : 1);
+    if (n == 0 || bytes == 0) return;
+    if (ksm.checksum.size() != n) ksm.checksum.assign(n, 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    ksm.stats.batches++;
+    for (u64 k = 0; k < ksm.pages; ++k) {
+        u64 f = ksm.cursor;
+        if (++ksm.cursor == n) {
+            ksm.cursor = 0;
+            ksm.unstable.clear();
+            ksm.stats.passes++;
+        }
+        ksm.stats.scanned++;
+        if (!mmu.frames.frames[f].in_use) continue;
+
+        const unsigned char* page = &mmu.ram[f * bytes];
+        u64 h = Ksm_Hash(page, bytes);
+        ksm.stats.hashed++;
+        bool settled = ksm.checksum[f] == h;
+        ksm.checksum[f] = h;
+        if (!settled) continue;
+
+        // Stable tree: an existing merged frame with these contents
+        auto it = ksm.stable.find(h);
+        if (it != ksm.stable.end() && it->second != f) {
+            u64 s = it->second;
+            ksm.stats.compared++;
+            if (mmu.frames.frames[s].in_use && std::memcmp(&mmu.ram[s * bytes], page, bytes) == 0) {
+                if (mmu.frames.frames[s].refs + mmu.frames.frames[f].refs > ksm.max_sharing) {
+                    it->second = f; // Full: f heads the next group
+                    continue;
+                }
+                Ksm_Merge(mmu, f, s);
+                ksm.checksum[f] = 0;
+                ksm.stats.merged++;
+                continue;
+            }
+            ksm.stable.erase(it); // Stale: the frame was written or reused
+        }
+        if (it != ksm.stable.end()) continue; // f is the stable copy itself
+
+        // Unstable tree: another settled page seen this pass
+        auto u = ksm.unstable.find(h);
+        if (u != ksm.unstable.end() && u->second != f) {
+            u64 s = u->second;
+            ksm.stats.compared++;
+            if (mmu.frames.frames[s].in_use && std::memcmp(&mmu.ram[s * bytes], page, bytes) == 0) {
+                Ksm_Merge(mmu, f, s);
+                ksm.checksum[f] = 0;
+                ksm.stats.merged++;
+                ksm.stable[h] = s;
+                ksm.unstable.erase(u);
+                continue;
+            }
+        }
+        ksm.unstable[h] = f;
+    }
+    ksm.stats.scan_ns += (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - t0).count();
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Per-Stage Latency Profiling
+   ===================================================
+   Build with -DPAGING_PROFILE=ON to enable. When it is off every
+   PROFILE_* macro expands to nothing and the hot path is untouched.
+
+   Each translation is split into stages (TLB lookup, table walk, fault
+   handling, eviction). Stage samples go into log-linear histograms; the
+   sum of a translation's stages is also filed under its outcome.       */
+
+enum ProfileStage { STAGE_TLB_LOOKUP, STAGE_WALK, STAGE_FAULT, STAGE_EVICT, STAGE_COUNT };
+enum ProfileOutcome { OUT_TLB_HIT, OUT_WALK_HIT, OUT_MINOR_FAULT, OUT_MAJOR_FAULT, OUT_COUNT };
+
+// --- Timestamp source: TSC where available, steady_clock otherwise ---
+inline u64 profile_now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Ticks per nanosecond, measured once against steady_clock (~5 ms)
+inline double profile_ticks_per_ns() {
+#if defined(__x86_64__) || defined(__i386__)
+    static double ratio = 0;
+    if (ratio == 0) {
+        auto c0 = std::chrono::steady_clock::now();
+        u64 t0 = profile_now();
+        while (std::chrono::steady_clock::now() - c0 < std::chrono::milliseconds(5)) {}
+        u64 t1 = profile_now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - c0).count();
+        ratio = (t1 - t0) / ns;
+    }
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+/* ---------------------------------------------------
+   Log-Linear (HDR-style) Histogram
+   Values below 16 get exact buckets; above that, each power of two is
+   split into 16 linear sub-buckets (relative error <= 1/16).           */
+struct LatencyHistogram {
+    static const int SUB_BITS = 4;
+    static const int SUB = 1 << SUB_BITS;
+    static const int NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    u64 counts[NUM_BUCKETS] = {};
+    u64 total = 0;
+    u64 sum = 0;
+    u64 max = 0;
+
+    static inline int index_of(u64 v) {
+        if (v < (u64)SUB) return (int)v;
+        int e = 63 - __builtin_clzll(v);
+        return (e - SUB_BITS + 1) * SUB + (int)((v >> (e - SUB_BITS)) & (SUB - 1));
+    }
+
+    static inline u64 lower_bound(int idx) {
+        if (idx < SUB) return (u64)idx;
+        int e = idx / SUB + SUB_BITS - 1;
+        u64 sub = (u64)(idx % SUB);
+        return (1ULL << e) | (sub << (e - SUB_BITS));
+    }
+
+    inline void record(u64 v) {
+        counts[index_of(v)]++;
+        total++;
+        sum += v;
+        if (v > max) max = v;
+    }
+
+    // Value at quantile q (0..1): midpoint of the bucket holding it
+    u64 percentile(double q) const {
+        if (total == 0) return 0;
+        u64 target = (u64)(q * total);
+        if (target >= total) target = total - 1;
+        u64 seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen > target) {
+                u64 lo = lower_bound(i);
+                u64 hi = (i + 1 < NUM_BUCKETS) ? lower_bound(i + 1) : lo;
+                u64 mid = lo + (hi - lo) / 2;
+                return mid < max ? mid : max;
+            }
+        }
+        return max;
+    }
+};
+
+/* ---------------------------------------------------
+   The Profile: one histogram per stage and per outcome */
+struct LatencyProfile {
+    LatencyHistogram stage[STAGE_COUNT];
+    LatencyHistogram outcome[OUT_COUNT];
+    u64 in_flight = 0; // Stage ticks accumulated by the current translation
+
+    inline void add_stage(ProfileStage s, u64 ticks) {
+        stage[s].record(ticks);
+        in_flight += ticks;
+    }
+
+    // A stage running inside another one (eviction inside a fault):
+    // recorded on its own, but already counted by the enclosing stage.
+    inline void add_nested(ProfileStage s, u64 ticks) {
+        stage[s].record(ticks);
+    }
+
+    inline void end_translation(ProfileOutcome o) {
+        outcome[o].record(in_flight);
+        in_flight = 0;
+    }
+
+    // The translation failed (e.g. out of memory): drop its partial sum
+    inline void discard_translation() {
+        in_flight = 0;
+    }
+
+    void print(FILE* out = stdout) const {
+        static const char* stage_names[] = {"tlb_lookup", "walk", "fault", "evict"};
+        static const char* outcome_names[] = {"tlb_hit", "walk_hit", "minor_fault", "major_fault"};
+        double tpn = profile_ticks_per_ns();
+
+        fprintf(out, "\n=== LATENCY PROFILE (ns) ===\n");
+        fprintf(out, "%-14s %10s %9s %9s %9s %9s %9s\n", "", "count", "mean", "p50", "p99", "p99.9", "max");
+        for (int i = 0; i < STAGE_COUNT; ++i) print_row(out, stage_names[i], stage[i], tpn);
+        fprintf(out, "--- by outcome ---\n");
+        for (int i = 0; i < OUT_COUNT; ++i) print_row(out, outcome_names[i], outcome[i], tpn);
+    }
+
+private:
+    static void print_row(FILE* out, const char* name, const LatencyHistogram& h, double tpn) {
+        if (h.total == 0) {
+            fprintf(out, "%-14s %10s\n", name, "-");
+            return;
+        }
+        fprintf(out, "%-14s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f\n", name,
+                (unsigned long long)h.total, (double)h.sum / h.total / tpn,
+                h.percentile(0.50) / tpn, h.percentile(0.99) / tpn,
+                h.percentile(0.999) / tpn, h.max / tpn);
+    }
+};
+
+inline LatencyProfile& Global_Profile() {
+    static LatencyProfile profile;
+    return profile;
+}
+
+// --- Instrumentation Macros ---
+#ifdef PAGING_PROFILE
+#define PROFILE_START(var)          u64 var = profile_now()
+#define PROFILE_STAGE(stage, var)   Global_Profile().add_stage(stage, profile_now() - var)
+#define PROFILE_NESTED(stage, var)  Global_Profile().add_nested(stage, profile_now() - var)
+#define PROFILE_OUTCOME(outcome)    Global_Profile().end_translation(outcome)
+#define PROFILE_DISCARD()           Global_Profile().discard_translation()
+#define PROFILE_REPORT()            Global_Profile().print()
+#else
+#define PROFILE_START(var)          ((void)0)
+#define PROFILE_STAGE(stage, var)   ((void)0)
+#define PROFILE_NESTED(stage, var)  ((void)0)
+#define PROFILE_OUTCOME(outcome)    ((void)0)
+#define PROFILE_DISCARD()           ((void)0)
+#define PROFILE_REPORT()            ((void)0)
+#endif
+
+#endif
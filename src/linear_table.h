@@ -0,0 +1,55 @@
+#ifndef LINEAR_TABLE_H
+#define LINEAR_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t u64;
+
+// --- Linear (Single-Level) Page Table, as in Milestone 3 ---
+// One entry per virtual page up to a fixed limit; VPNs beyond it seg-fault.
+
+struct LinearPTE {
+    long long frame_number = -1; // physical frame number
+    bool is_valid = false;       // valid / invalid
+};
+
+struct LinearPageTable {
+    std::vector<LinearPTE> entries;
+    u64 live_entries = 0;
+
+    explicit LinearPageTable(u64 max_virtual_pages) : entries(max_virtual_pages) {}
+};
+
+// nullptr if the VPN is out of bounds or not present
+inline LinearPTE* Linear_Lookup(LinearPageTable* table, u64 VPN) {
+    if (VPN >= table->entries.size()) return nullptr;
+    LinearPTE* pte = &table->entries[VPN];
+    return pte->is_valid ? pte : nullptr;
+}
+
+// false on a segmentation fault (VPN beyond the table)
+inline bool Linear_Map(LinearPageTable* table, u64 VPN, u64 frame) {
+    if (VPN >= table->entries.size()) return false;
+    LinearPTE& pte = table->entries[VPN];
+    if (!pte.is_valid) table->live_entries++;
+    pte.frame_number = (long long)frame;
+    pte.is_valid = true;
+    return true;
+}
+
+inline long long Linear_Unmap(LinearPageTable* table, u64 VPN) {
+    LinearPTE* pte = Linear_Lookup(table, VPN);
+    if (pte == nullptr) return -1;
+    long long frame = pte->frame_number;
+    pte->is_valid = false;
+    pte->frame_number = -1;
+    table->live_entries--;
+    return frame;
+}
+
+inline u64 Linear_Bytes(const LinearPageTable* table) {
+    return table->entries.size() * sizeof(LinearPTE);
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef MAGAZINE_H
+#define MAGAZINE_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Per-CPU Frame Magazines
+   ===================================================
+   A small stack of free frames per simulated CPU in front of a global
+   allocator (freeList or BuddyAllocator: anything with
+   allocate_frame(G*) and free_frame(G*, int)). Every trip to the
+   global allocator stands for one acquisition of its lock.
+
+     alloc  pop from this CPU's magazine; at or below `low` frames it
+            first refills `batch` frames in one global trip
+     free   push onto this CPU's magazine; above `high` frames it
+            drains up to `batch` of its coldest frames in one global
+            trip (`high` 0 with `batch` 1 is no cache at all)
+
+   If the global allocator runs dry, every CPU's magazine is drained
+   back (one trip each) before an allocation is allowed to fail, so no
+   frame is stranded on an idle CPU. Freed frames are reused LIFO, the
+   cache-warm ones first.                                              */
+
+struct MagazineStats {
+    u64 allocs = 0;
+    u64 frees = 0;
+    u64 refills = 0;
+    u64 drains = 0;
+    u64 global_locks = 0; // Trips to the global allocator
+};
+
+template <class Global>
+struct FrameMagazines {
+    Global* global = nullptr;
+    u64 batch = 8;
+    u64 low = 0;
+    u64 high = 16;
+    std::vector<std::vector<uint32_t>> cpu; // Per CPU; top = most recently freed
+    MagazineStats stats;
+};
+
+template <class Global>
+void Magazine_Init(FrameMagazines<Global>* m, Global* global, int cpus, u64 batch, u64 low, u64 high) {
+    m->global = global;
+    m->batch = batch ? batch : 1;
+    m->low = low;
+    m->high = high;
+    m->cpu.assign(cpus, std::vector<uint32_t>());
+    m->stats = MagazineStats();
+}
+
+// Up to `batch` frames from the global allocator into one CPU's magazine
+template <class Global>
+u64 Magazine_Refill(FrameMagazines<Global>* m, int cpu) {
+    m->stats.global_locks++;
+    m->stats.refills++;
+    u64 got = 0;
+    for (; got < m->batch; ++got) {
+        long long frame = allocate_frame(m->global);
+        if (frame < 0) break;
+        m->cpu[cpu].push_back((uint32_t)frame);
+    }
+    return got;
+}
+
+// Returns up to `count` of the CPU's coldest frames to the global allocator
+template <class Global>
+void Magazine_Drain(FrameMagazines<Global>* m, int cpu, u64 count) {
+    std::vector<uint32_t>& mag = m->cpu[cpu];
+    if (count > mag.size()) count = mag.size();
+    if (count == 0) return;
+    m->stats.global_locks++;
+    m->stats.drains++;
+    for (u64 i = 0; i < count; ++i) free_frame(m->global, (int)mag[i]);
+    mag.erase(mag.begin(), mag.begin() + count);
+}
+
+template <class Global>
+long long Magazine_Alloc(FrameMagazines<Global>* m, int cpu) {
+    std::vector<uint32_t>& mag = m->cpu[cpu];
+    if (mag.size() <= m->low && Magazine_Refill(m, cpu) == 0 && mag.empty()) {
+        // Global allocator empty: pull back what the other CPUs hold
+        for (std::size_t c = 0; c < m->cpu.size(); ++c) Magazine_Drain(m, (int)c, m->cpu[c].size());
+        if (Magazine_Refill(m, cpu) == 0) return -1;
+    }
+    m->stats.allocs++;
+    long long frame = mag.back();
+    mag.pop_back();
+    return frame;
+}
+
+template <class Global>
+void Magazine_Free(FrameMagazines<Global>* m, int cpu, u64 frame) {
+    m->stats.frees++;
+    m->cpu[cpu].push_back((uint32_t)frame);
+    if (m->cpu[cpu].size() > m->high) Magazine_Drain(m, cpu, m->batch);
+}
+
+// Frames parked in magazines: taken from the global allocator, not in use
+template <class Global>
+u64 Magazine_Cached(const FrameMagazines<Global>* m) {
+    u64 n = 0;
+    for (const std::vector<uint32_t>& mag : m->cpu) n += mag.size();
+    return n;
+}
+
+template <class Global>
+void Magazine_Print(const FrameMagazines<Global>* m, std::ostream& out) {
+    const MagazineStats& s = m->stats;
+    u64 ops = s.allocs + s.frees;
+    out << "   [PCP] Cached:";
+    for (const std::vector<uint32_t>& mag : m->cpu) out << " " << mag.size();
+    out << " | Allocs: " << s.allocs << " Frees: " << s.frees << " | Refills: " << s.refills
+        << " Drains: " << s.drains << "\n";
+    out << "   [PCP] Global lock acquisitions: " << s.global_locks << " (avoided "
+        << (ops > s.global_locks ? ops - s.global_locks : 0) << " of " << ops << ")\n";
+}
+
+#endif
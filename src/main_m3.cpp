@@ -3,7 +3,17 @@
 #include <cassert>
 #include <fstream>
 #include <cstdint>
+#include <cstring>
 #include <iomanip> // For nice formatting
+#include <vector>
+#include "buddy.h"
+#include "inverted_table.h"
+#include "latency.h"
+#include "magazine.h"
+#include "stats.h"
+#include "tlb.h"
+#include "tlb_prefetch.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -24,123 +34,67 @@ const int TABLE_SIZE = 10; // Small size to force collisions
 // TLB CONFIG
 const int TLB_TABLE_SIZE = 4; // Small size to force LRU eviction
 
+// TLB PREFETCH CONFIG
+const int TLB_PF_BUFFER = 16; // Prefetch buffer entries (fully associative, FIFO)
+
+// PER-CPU FRAME CACHE CONFIG
+const int NUM_CPUS = 4;
+const u64 PCP_BATCH = 4; // Frames moved per trip to the global allocator
+const u64 PCP_LOW = 0;   // Refill at or below this many cached frames
+const u64 PCP_HIGH = 8;  // Drain above this many
+
 // Error Codes
 const u64 ERR_PAGE_FAULT = -1;
 
-// GLOBAL CLOCK (For LRU)
-u64 Global_System_Clock = 0;
-
 /* ===================================================
    SECTION 2: Physical Memory (Hardware)
    =================================================== */
 unsigned char RAM[RAM_SIZE];
 
-typedef struct {
-    int fram[TOTAL_FRAMES];
-    int top;
-} freeList;
-
-freeList physical_memory;
-
-void init_free_list(freeList* list) {
-    list->top = -1;
-    for (int i = 0; i < TOTAL_FRAMES; ++i) {
-        list->top++;
-        list->fram[list->top] = i;
-    }
-}
-
-long long allocate_frame(freeList* list) {
-    if (list->top == -1) return -1;
-    int allocated_frame = list->fram[list->top];
-    list->top--;
-    return allocated_frame;
-}
+BuddyAllocator physical_memory;
+FrameMagazines<BuddyAllocator> frame_cache; // Per-CPU front end to physical_memory
+u64 Page_Faults = 0;
 
 /* ===================================================
    SECTION 3: Inverted Page Table (The Slow Path)
    =================================================== */
-struct Node {
-    u64 PID;
-    u64 VPN;
-    u64 PFN;
-    Node* next;
-};
-
-struct HashTable {
-    Node* buckets[TABLE_SIZE];
-};
-
-HashTable* System_IPT = new HashTable;
-
-void Init_IPT() {
-    for(int i=0; i<TABLE_SIZE; i++) {
-        System_IPT->buckets[i] = NULL;
-    }
-}
+HashTable* System_IPT = new HashTable(TABLE_SIZE);
 
 // --- Helpers ---
 u64 get_VPN(u64 VA) { return VA >> 12; }
 u64 get_offset(u64 VA) { return VA & 0xFFF; }
 u64 construct_PA(u64 frame, u64 offset) { return (frame << 12) | offset; }
 
-u64 Hash_Function(u64 PID, u64 VPN) {
-    u64 combined = PID ^ VPN;
-    return combined % TABLE_SIZE;
-}
-
-// --- IPT Logic ---
-Node* find_node(Node* head, u64 PID, u64 VPN) {
-    Node* current = head;
-    while (current != NULL) {
-        if (current->PID == PID && current->VPN == VPN) {
-            return current;
-        }
-        current = current->next;
-    }
-    return NULL;
-}
-
-void insert_node(u64 PID, u64 VPN, u64 PFN) {
-    u64 idx = Hash_Function(PID, VPN);
-
-    // Check if update existing
-    Node* existing = find_node(System_IPT->buckets[idx], PID, VPN);
-    if (existing) {
-        existing->PFN = PFN;
-        return;
-    }
-
-    // Insert New (Head Insertion)
-    Node* new_node = new Node;
-    new_node->PID = PID;
-    new_node->VPN = VPN;
-    new_node->PFN = PFN;
-    new_node->next = System_IPT->buckets[idx];
-    System_IPT->buckets[idx] = new_node;
-}
+// Each process is pinned to one CPU
+int CPU_Of(u64 PID) { return (int)(PID % NUM_CPUS); }
 
 // The "Heavy" Translator
 u64 Translate_Inverted(u64 PID, u64 VA) {
     u64 vpn = get_VPN(VA);
     u64 offset = get_offset(VA);
-    u64 idx = Hash_Function(PID, vpn);
-
     // 1. Lookup
-    Node* target = find_node(System_IPT->buckets[idx], PID, vpn);
+    PROFILE_START(t_walk);
+    Node* target = IPT_Lookup(System_IPT, PID, vpn);
+    PROFILE_STAGE(STAGE_WALK, t_walk);
 
     u64 pfn;
     if (target != NULL) {
         pfn = target->PFN;
+        PROFILE_OUTCOME(OUT_WALK_HIT);
     } else {
         // Page Fault -> Allocate Frame
-        long long new_frame = allocate_frame(&physical_memory);
+        PROFILE_START(t_fault);
+        long long new_frame = Magazine_Alloc(&frame_cache, CPU_Of(PID));
         if (new_frame == -1) {
+            PROFILE_DISCARD();
             cout << "CRITICAL ERROR: Out of RAM!\n";
             return ERR_PAGE_FAULT;
         }
-        insert_node(PID, vpn, new_frame);
+        insert_node(System_IPT, PID, vpn, new_frame);
+        Page_Faults++;
         pfn = new_frame;
+        PROFILE_STAGE(STAGE_FAULT, t_fault);
+        PROFILE_OUTCOME(OUT_MINOR_FAULT); // Free frame available, no eviction
     }
 
     return construct_PA(pfn, offset);
@@ -150,71 +104,33 @@ u64 Translate_Inverted(u64 PID, u64 VA) {
    SECTION 4: TLB Simulator (The Fast Path) ⚡
    =================================================== */
 
-struct TLBEntry {
-    u64 PID;
-    u64 VPN;
-    u64 PFN;
-    bool is_vaild;
-    u64 Timestampe; // For LRU
-};
+// Default: ASID-tagged with a 12-bit PCID space, so distinct PIDs coexist
+TLB* System_TLB = new TLB(TLB_TABLE_SIZE, TLB_ASID_TAGGED, 4096);
 
-struct TLB_table {
-    TLBEntry array[TLB_TABLE_SIZE];
-};
-
-TLB_table* System_TLB = new TLB_table;
-
-// 1. Lookup (Reader)
-long long TLB_Lookup(u64 PID, u64 VA) {
-    u64 VPN = get_VPN(VA);
-
-    for (int i = 0; i < TLB_TABLE_SIZE; ++i) {
-        // Check for Valid Match
-        if (System_TLB->array[i].is_vaild &&
-            System_TLB->array[i].PID == PID &&
-            System_TLB->array[i].VPN == VPN) {
-
-            // HIT! Update LRU Time
-            Global_System_Clock++;
-            System_TLB->array[i].Timestampe = Global_System_Clock;
-            return System_TLB->array[i].PFN;
-        }
-    }
-    // Return -1 AFTER checking everyone
-    return -1;
+// 1. Lookup (Reader), for the running process
+long long TLB_Lookup(u64 VA) {
+    return System_TLB->lookup(get_VPN(VA));
 }
 
-// 2. Update (Writer + LRU Eviction)
-void TLB_Update(u64 PID, u64 VPN, u64 PFN) {
-    // A. Try to find empty spot
-    for (int i = 0; i < TLB_TABLE_SIZE; ++i) {
-        if (System_TLB->array[i].is_vaild == false) {
-            System_TLB->array[i].PID = PID;
-            System_TLB->array[i].VPN = VPN;
-            System_TLB->array[i].PFN = PFN;
-            System_TLB->array[i].is_vaild = true;
-            System_TLB->array[i].Timestampe = Global_System_Clock;
-            return;
-        }
-    }
+// 2. Update (Writer + LRU Eviction), for the running process
+void TLB_Update(u64 VPN, u64 PFN) {
+    System_TLB->update(VPN, PFN);
+}
 
-    // B. If full, Find Victim (Oldest Timestamp)
-    int victim_index = 0;
-    u64 min_time = System_TLB->array[0].Timestampe;
+// The CPU only issues for the running process. A 'C' record switches
+// explicitly; an access by another PID is a switch the trace left out.
+// The TLB ignores a switch to the PID already running.
+void Run_Process(u64 PID) {
+    System_TLB->context_switch(PID);
+}
 
-    for (int i = 1; i < TLB_TABLE_SIZE; ++i) {
-        if (System_TLB->array[i].Timestampe < min_time) {
-            min_time = System_TLB->array[i].Timestampe;
-            victim_index = i;
-        }
-    }
+// 3. Prefetch buffer beside the TLB (off until menu option 7 picks a predictor)
+TLBPrefetcher System_TLB_Prefetch;
 
-    // C. Overwrite Victim
-    System_TLB->array[victim_index].PID = PID;
-    System_TLB->array[victim_index].VPN = VPN;
-    System_TLB->array[victim_index].PFN = PFN;
-    System_TLB->array[victim_index].is_vaild = true;
-    System_TLB->array[victim_index].Timestampe = Global_System_Clock;
+// Speculative walk: a translation if one exists, never a page fault
+long long Walk_Speculative(u64 PID, u64 VPN) {
+    Node* target = IPT_Lookup(System_IPT, PID, VPN);
+    return target ? (long long)target->PFN : -1;
 }
 
 /* ===================================================
@@ -227,23 +143,40 @@ u64 Translate_With_TLB(u64 PID, u64 VA) {
     u64 VPN = get_VPN(VA);
     u64 offset = get_offset(VA);
 
+    Run_Process(PID);
+
     // Step 1: Try Fast Path
-    long long tlb_pfn = TLB_Lookup(PID, VA);
+    PROFILE_START(t_tlb);
+    long long tlb_pfn = TLB_Lookup(VA);
+    PROFILE_STAGE(STAGE_TLB_LOOKUP, t_tlb);
+
+    System_TLB->record(tlb_pfn != -1);
 
     if (tlb_pfn != -1) {
+        PROFILE_OUTCOME(OUT_TLB_HIT);
         TLB_Hits++;
         return (tlb_pfn << 12) | offset;
     }
 
-    // Step 2: Slow Path (Miss)
-    TLB_Misses++;
-    u64 PA = Translate_Inverted(PID, VA);
-
-    if (PA == ERR_PAGE_FAULT) return ERR_PAGE_FAULT;
+    // Step 2: Prefetch Buffer (filled by earlier misses, saves the walk)
+    u64 PA;
+    long long pb_pfn = TLBPrefetch_Lookup(&System_TLB_Prefetch, PID, VPN);
+    if (pb_pfn != -1) {
+        PROFILE_OUTCOME(OUT_TLB_HIT);
+        PA = construct_PA(pb_pfn, offset);
+    } else {
+        // Step 3: Slow Path (Miss)
+        TLB_Misses++;
+        PA = Translate_Inverted(PID, VA);
+        if (PA == ERR_PAGE_FAULT) return ERR_PAGE_FAULT;
+    }
 
-    // Step 3: Update Cache
+    // Step 4: Update Cache
     u64 new_PFN = PA >> 12;
-    TLB_Update(PID, VPN, new_PFN);
+    TLB_Update(VPN, new_PFN);
+
+    // Step 5: Speculative walks for the pages predicted to miss next
+    TLBPrefetch_Issue(&System_TLB_Prefetch, System_TLB, PID, VPN, Walk_Speculative);
 
     return PA;
 }
@@ -253,12 +186,13 @@ u64 Translate_With_TLB(u64 PID, u64 VA) {
    =================================================== */
 
 void Print_TLB_State() {
-    cout << "\n   [DEBUG] TLB State (Current Time: " << Global_System_Clock << ")\n";
+    cout << "\n   [DEBUG] TLB State (Current Time: " << System_TLB->clock << ")\n";
     cout << "   --------------------------------------------------------------\n";
     for(int i=0; i<TLB_TABLE_SIZE; ++i) {
         cout << "   Slot " << i << ": ";
         if(System_TLB->array[i].is_vaild) {
             cout << "PID:" << System_TLB->array[i].PID
+                 << " | ASID:" << System_TLB->array[i].ASID
                  << " | VPN:" << System_TLB->array[i].VPN
                  << " | PFN:" << System_TLB->array[i].PFN
                  << " | Time:" << System_TLB->array[i].Timestampe << "\n";
@@ -272,8 +206,9 @@ void Print_TLB_State() {
 void Visualize_Translation(u64 PID, u64 VA) {
     cout << "\n   [VISUALIZER] Inspecting PID: " << PID << " VA: 0x" << hex << VA << dec << "\n";
 
-    // Check TLB
-    long long tlb_pfn = TLB_Lookup(PID, VA); // Note: This will update timestamp if hit!
+    // Check TLB (as that process sees it)
+    Run_Process(PID);
+    long long tlb_pfn = TLB_Lookup(VA); // Note: This will update timestamp if hit!
 
     if (tlb_pfn != -1) {
         cout << "   └── TLB: HIT! 🎯 -> Frame " << tlb_pfn << "\n";
@@ -282,10 +217,10 @@ void Visualize_Translation(u64 PID, u64 VA) {
 
         // Show Hashing
         u64 vpn = get_VPN(VA);
-        u64 idx = Hash_Function(PID, vpn);
+        u64 idx = Hash_Function(System_IPT, PID, vpn);
         Node* current = System_IPT->buckets[idx];
 
-        cout << "       └── Hashing: (" << PID << "^" << vpn << ") % 10 = Bucket " << idx << "\n";
+        cout << "       └── Hashing: (" << PID << "^" << vpn << ") % " << TABLE_SIZE << " = Bucket " << idx << "\n";
         bool found = false;
         while(current) {
             cout << "           └── Checking Node [PID:" << current->PID << ", VPN:" << current->VPN << "]... ";
@@ -305,8 +240,26 @@ void Visualize_Translation(u64 PID, u64 VA) {
    SECTION 7: User Interface (Store/Load)
    =================================================== */
 
+// Interval time series (enabled by passing an output path)
+IntervalStats* Interval_Stats = nullptr;
+u64 Accesses = 0;
+
+void Record_Interval() {
+    Accesses++;
+    if (Interval_Stats == nullptr || !Interval_Stats->due()) return;
+    SimCounters c;
+    c.accesses = Accesses;
+    c.hits = Accesses - Page_Faults;
+    c.faults = Page_Faults;
+    c.tlb_misses = TLB_Misses;
+    c.page_table_bytes = IPT_Bytes(System_IPT);
+    c.resident_pages = TOTAL_FRAMES - physical_memory.free_pages - Magazine_Cached(&frame_cache);
+    Interval_Stats->snapshot(c);
+}
+
 void Store(u64 PID, u64 VA, char data) {
     u64 PA = Translate_With_TLB(PID, VA);
+    Record_Interval();
     if (PA != ERR_PAGE_FAULT) {
         RAM[PA] = data;
         cout << "   [RAM] PID " << PID << " Stored '" << data << "' at PA 0x" << hex << PA << dec << "\n";
@@ -315,6 +268,7 @@ void Store(u64 PID, u64 VA, char data) {
 
 char Load(u64 PID, u64 VA) {
     u64 PA = Translate_With_TLB(PID, VA);
+    Record_Interval();
     if (PA != ERR_PAGE_FAULT) {
         cout << "   [RAM] PID " << PID << " Loaded '" << RAM[PA] << "' from PA 0x" << hex << PA << dec << "\n";
         return RAM[PA];
@@ -322,19 +276,47 @@ char Load(u64 PID, u64 VA) {
     return '?';
 }
 
+// Bulk versions: split at page boundaries, one translation and one
+// memcpy per page, one console line per call. Return the bytes moved.
+u64 Store_Range(u64 PID, u64 VA, const unsigned char* data, u64 len) {
+    u64 done = 0, pages = 0;
+    while (done < len) {
+        u64 chunk = min(pageSize - get_offset(VA + done), len - done);
+        u64 PA = Translate_With_TLB(PID, VA + done);
+        Record_Interval();
+        if (PA == ERR_PAGE_FAULT) break;
+        memcpy(&RAM[PA], data + done, chunk);
+        done += chunk;
+        pages++;
+    }
+    cout << "   [RAM] PID " << PID << " Stored " << done << " bytes at VA 0x" << hex << VA << dec
+         << " (" << pages << " translations)\n";
+    return done;
+}
+
+u64 Load_Range(u64 PID, u64 VA, unsigned char* out, u64 len) {
+    u64 done = 0, pages = 0;
+    while (done < len) {
+        u64 chunk = min(pageSize - get_offset(VA + done), len - done);
+        u64 PA = Translate_With_TLB(PID, VA + done);
+        Record_Interval();
+        if (PA == ERR_PAGE_FAULT) break;
+        memcpy(out + done, &RAM[PA], chunk);
+        done += chunk;
+        pages++;
+    }
+    cout << "   [RAM] PID " << PID << " Loaded " << done << " bytes from VA 0x" << hex << VA << dec
+         << " (" << pages << " translations)\n";
+    return done;
+}
+
 u64 hex_to_int(string hex) {
     return stoull(hex, nullptr, 16);
 }
 
 void System_Boot() {
-    init_free_list(&physical_memory);
-    Init_IPT();
-
-    // Clean TLB Registers
-    for (int i = 0; i < TLB_TABLE_SIZE; ++i) {
-        System_TLB->array[i].is_vaild = false;
-        System_TLB->array[i].Timestampe = 0;
-    }
+    Buddy_Init(&physical_memory, TOTAL_FRAMES);
+    Magazine_Init(&frame_cache, &physical_memory, NUM_CPUS, PCP_BATCH, PCP_LOW, PCP_HIGH);
 
     cout << "System Booted. Inverted Page Table + TLB Ready.\n";
 }
@@ -361,22 +343,26 @@ void run_batch_test() {
     ifstream inputFile("input_tlb.txt");
     if (!inputFile.is_open()) return;
 
-    string hexAddr;
-    char op, data;
-    u64 pid;
+    TraceRecord rec;
 
-    while (inputFile >> op >> pid >> hexAddr) {
-        u64 VA = hex_to_int(hexAddr);
-        cout << "\nCMD: " << op << " PID:" << pid << " VA:" << hexAddr << "\n";
+    while (Read_Trace_Record(inputFile, rec)) {
+        u64 pid = rec.pid, VA = rec.va;
+        cout << "\nCMD: " << rec.op << " PID:" << pid << " VA:0x" << hex << VA << dec << "\n";
 
-        if (op == 'W') {
-            inputFile >> data;
-            Store(pid, VA, data);
-        } else if (op == 'R') {
+        if (rec.op == 'W') {
+            Store(pid, VA, rec.data);
+        } else if (rec.op == 'R') {
             Load(pid, VA);
-        } else if (op == 'V') {
+        } else if (is_bulk_op(rec.op)) {
+            vector<unsigned char> buf(rec.len, (unsigned char)rec.data);
+            if (rec.op == 'S') Store_Range(pid, VA, buf.data(), rec.len);
+            else if (rec.op == 'L') Load_Range(pid, VA, buf.data(), rec.len);
+            else if (Load_Range(pid, rec.src, buf.data(), rec.len) == rec.len) Store_Range(pid, VA, buf.data(), rec.len);
+        } else if (rec.op == 'V') {
             Visualize_Translation(pid, VA);
             Print_TLB_State();
+        } else if (rec.op == 'C') {
+            Run_Process(pid);
         }
     }
     inputFile.close();
@@ -384,12 +370,225 @@ void run_batch_test() {
     cout << "\n=== STATS ===\n";
     cout << "TLB Hits: " << TLB_Hits << "\n";
     cout << "TLB Misses: " << TLB_Misses << "\n";
+    if (System_TLB_Prefetch.kind != TLB_PF_NONE) {
+        const TLBPrefetcher* pf = &System_TLB_Prefetch;
+        cout << "TLB Prefetch (" << TLBPrefetch_Name(pf->kind) << "): " << pf->stats.hits << " buffer hits, "
+             << pf->stats.walks << " speculative walks, " << fixed << setprecision(1)
+             << 100.0 * TLBPrefetch_Accuracy(pf) << "% accuracy, " << 100.0 * TLBPrefetch_Coverage(pf, TLB_Misses)
+             << "% coverage\n";
+        cout.unsetf(ios::fixed);
+    }
+    Buddy_Print(&physical_memory, cout);
+    Magazine_Print(&frame_cache, cout);
+    cout.flush();
+    PROFILE_REPORT();
 }
 
-int main() {
+/* ===================================================
+   SECTION 8: Context-Switch Cost (Flush vs ASID)
+   =================================================== */
+
+// Replays one trace under a given TLB configuration and prints a row.
+void Replay_With_TLB(const string& label, TLB* tlb, const string& path) {
+    TLB* saved_tlb = System_TLB;
+    int saved_hits = TLB_Hits, saved_misses = TLB_Misses;
+    System_TLB = tlb;
+    TLB_Hits = TLB_Misses = 0;
+
+    ifstream inputFile(path);
+    TraceRecord rec;
+    while (Read_Trace_Record(inputFile, rec)) {
+        if (rec.op == 'C') tlb->context_switch(rec.pid);
+        else if (rec.op == 'W' || rec.op == 'R') Translate_With_TLB(rec.pid, rec.va);
+    }
+    tlb->close_burst();
+
+    const TLBSwitchStats& st = tlb->stats;
+    double miss_rate = 100.0 * TLB_Misses / (TLB_Hits + TLB_Misses);
+    double window_rate = st.window_accesses ? 100.0 * st.window_misses / st.window_accesses : 0;
+    double avg_burst = st.bursts ? (double)st.burst_misses / st.bursts : 0;
+
+    cout << left << setw(18) << label << right
+         << setw(8) << fixed << setprecision(1) << miss_rate << "%"
+         << setw(10) << window_rate << "%"
+         << setw(10) << avg_burst
+         << setw(8) << st.max_burst
+         << setw(10) << st.entries_flushed
+         << setw(10) << st.asid_recycles << "\n";
+
+    System_TLB = saved_tlb;
+    TLB_Hits = saved_hits;
+    TLB_Misses = saved_misses;
+}
+
+void run_context_switch_test() {
+    cout << "\n=== RUNNING CONTEXT-SWITCH TEST ===\n";
+
+    // Scenario: 4 tenants round-robin, 12 accesses per quantum over 6
+    // private pages each. A 32-entry TLB can hold all of them at once,
+    // so whatever misses remain after warmup are caused by switching.
+    const int TENANTS = 4, PAGES = 6, QUANTUM = 12, ROUNDS = 20;
+
+    ofstream out("input_ctx.txt");
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (int p = 1; p <= TENANTS; ++p) {
+            out << "C " << (10 + p) << "\n";
+            for (int i = 0; i < QUANTUM; ++i) {
+                out << "R " << (10 + p) << " 0x" << hex << ((i % PAGES) + 1) * pageSize << dec << "\n";
+            }
+        }
+    }
+    out.close();
+
+    cout << left << setw(18) << "Mode" << right
+         << setw(9) << "Miss" << setw(11) << "PostSw"
+         << setw(10) << "AvgBurst" << setw(8) << "MaxB"
+         << setw(10) << "Flushed" << setw(10) << "Recycled" << "\n";
+
+    TLB flush(32, TLB_FLUSH_ON_SWITCH);
+    TLB asid2(32, TLB_ASID_TAGGED, 2);
+    TLB asid4(32, TLB_ASID_TAGGED, 4);
+    Replay_With_TLB("Flush on switch", &flush, "input_ctx.txt");
+    Replay_With_TLB("ASID x2", &asid2, "input_ctx.txt");
+    Replay_With_TLB("ASID x4", &asid4, "input_ctx.txt");
+    cout.unsetf(ios::fixed);
+    cout << "(PostSw = miss rate in the first " << flush.window << " accesses after a switch)\n";
+}
+
+/* ===================================================
+   SECTION 9: Per-CPU Frame Caches (Lock Traffic)
+   =================================================== */
+
+// Replays the same alloc/free churn through magazines of one batch size
+// on a private allocator and prints a row.
+void Replay_Frame_Churn(u64 batch, u64 high, int rounds) {
+    BuddyAllocator global;
+    Buddy_Init(&global, TOTAL_FRAMES);
+    FrameMagazines<BuddyAllocator> pcp;
+    Magazine_Init(&pcp, &global, NUM_CPUS, batch, PCP_LOW, high);
+
+    // Every round each CPU faults in a burst of 2..8 frames, the bursts
+    // interleaved one frame at a time, then frees them all (exit/munmap).
+    u64 failures = 0;
+    vector<vector<long long>> held(NUM_CPUS);
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < 8; ++i) {
+            for (int cpu = 0; cpu < NUM_CPUS; ++cpu) {
+                if (i >= 2 + (r + 3 * cpu) % 7) continue;
+                long long frame = Magazine_Alloc(&pcp, cpu);
+                if (frame < 0) failures++;
+                else held[cpu].push_back(frame);
+            }
+        }
+        for (int cpu = 0; cpu < NUM_CPUS; ++cpu) {
+            for (long long frame : held[cpu]) Magazine_Free(&pcp, cpu, frame);
+            held[cpu].clear();
+        }
+    }
+
+    const MagazineStats& s = pcp.stats;
+    u64 ops = s.allocs + s.frees;
+    cout << setw(6) << batch << setw(6) << high
+         << setw(8) << ops << setw(8) << s.global_locks
+         << setw(9) << fixed << setprecision(1) << 100.0 * (ops - s.global_locks) / ops << "%"
+         << setw(9) << s.refills << setw(8) << s.drains
+         << setw(8) << Magazine_Cached(&pcp) << setw(6) << failures << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+void run_frame_cache_test() {
+    cout << "\n=== RUNNING PER-CPU FRAME CACHE TEST ===\n";
+    cout << NUM_CPUS << " CPUs faulting concurrently into " << TOTAL_FRAMES << " frames\n";
+    cout << setw(6) << "Batch" << setw(6) << "High"
+         << setw(8) << "Ops" << setw(8) << "Locks" << setw(10) << "Avoided"
+         << setw(9) << "Refills" << setw(8) << "Drains"
+         << setw(8) << "Cached" << setw(6) << "OOM" << "\n";
+    Replay_Frame_Churn(1, 0, 50); // No cache: every op takes the lock
+    Replay_Frame_Churn(4, 8, 50);
+    Replay_Frame_Churn(8, 16, 50);
+    Replay_Frame_Churn(16, 32, 50); // Magazines hoard memory: drained on exhaustion
+    cout << "(Cached = frames parked in magazines at the end; OOM = failed allocations)\n";
+}
+
+/* ===================================================
+   SECTION 10: TLB Prefetching (Do the Extra Walks Pay?)
+   =================================================== */
+
+// Replays one VPN stream of PID 1 through a fresh TLB and the given
+// prefetcher, on a private page table holding exactly the stream's
+// pages, and prints a row. TLB_Misses counts the walks still on demand.
+void Replay_With_Prefetcher(const string& workload, const vector<u64>& vpns, TLBPrefetchKind kind) {
+    HashTable* saved_ipt = System_IPT;
+    TLB* saved_tlb = System_TLB;
+    int saved_hits = TLB_Hits, saved_misses = TLB_Misses;
+    TLBPrefetcher saved_pf;
+    swap(saved_pf, System_TLB_Prefetch);
+
+    HashTable ipt(256);
+    for (u64 vpn : vpns) insert_node(&ipt, 1, vpn, vpn % TOTAL_FRAMES); // Contents never touched
+    TLB tlb(TLB_TABLE_SIZE, TLB_ASID_TAGGED, 4096);
+    System_IPT = &ipt;
+    System_TLB = &tlb;
+    TLB_Hits = TLB_Misses = 0;
+    TLBPrefetch_Init(&System_TLB_Prefetch, kind, TLB_PF_BUFFER);
+
+    for (u64 vpn : vpns) Translate_With_TLB(1, vpn << 12);
+
+    const TLBPrefetcher* pf = &System_TLB_Prefetch;
+    cout << left << setw(12) << workload << setw(12) << TLBPrefetch_Name(kind) << right
+         << setw(8) << TLB_Misses << setw(8) << pf->stats.walks << setw(8) << pf->stats.hits
+         << setw(9) << fixed << setprecision(1) << 100.0 * TLBPrefetch_Accuracy(pf) << "%"
+         << setw(9) << 100.0 * TLBPrefetch_Coverage(pf, TLB_Misses) << "%"
+         << setw(8) << TLBPrefetch_Wasted(pf) << "\n";
+    cout.unsetf(ios::fixed);
+
+    swap(saved_pf, System_TLB_Prefetch);
+    System_IPT = saved_ipt;
+    System_TLB = saved_tlb;
+    TLB_Hits = saved_hits;
+    TLB_Misses = saved_misses;
+}
+
+void run_tlb_prefetch_test() {
+    cout << "\n=== RUNNING TLB PREFETCH TEST ===\n";
+
+    // Four sweeps of 256 accesses each, one per page, so every access
+    // misses the 4-entry TLB unless it was prefetched
+    const u64 BASE = 0x100, SWEEPS = 4, STEPS = 256;
+    vector<u64> seq, stride, alternating, random;
+    u64 rng = 12345;
+    for (u64 s = 0; s < SWEEPS; ++s) {
+        for (u64 i = 0; i < STEPS; ++i) {
+            seq.push_back(BASE + i);
+            stride.push_back(BASE + 4 * i);
+            alternating.push_back(BASE + 6 * (i / 2) + (i % 2)); // +1 +5 +1 +5 ...
+            rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+            random.push_back(BASE + (rng >> 33) % STEPS);
+        }
+    }
+
+    cout << left << setw(12) << "Workload" << setw(12) << "Prefetcher" << right
+         << setw(8) << "Walks" << setw(8) << "Spec" << setw(8) << "PBHits"
+         << setw(10) << "Accuracy" << setw(10) << "Coverage" << setw(8) << "Wasted" << "\n";
+    const TLBPrefetchKind kinds[] = {TLB_PF_NONE, TLB_PF_SEQUENTIAL, TLB_PF_STRIDE, TLB_PF_DISTANCE};
+    for (TLBPrefetchKind kind : kinds) Replay_With_Prefetcher("seq", seq, kind);
+    for (TLBPrefetchKind kind : kinds) Replay_With_Prefetcher("stride4", stride, kind);
+    for (TLBPrefetchKind kind : kinds) Replay_With_Prefetcher("+1/+5", alternating, kind);
+    for (TLBPrefetchKind kind : kinds) Replay_With_Prefetcher("random", random, kind);
+    cout << "(Walks = demand walks left; Spec = speculative walks; Wasted = unmapped or evicted unused)\n";
+}
+
+// Usage: paging_sim_m3 [stats.csv|stats.json] [interval]
+int main(int argc, char** argv) {
+    u64 every = 1;
+    if (argc > 2 && !Parse_Interval(argv[2], &every)) {
+        cerr << "Error: interval must be a positive integer, got " << argv[2] << endl;
+        return 1;
+    }
+    if (argc > 1) Interval_Stats = new IntervalStats(every);
     System_Boot();
 
-    int choice;
+    int choice = 0;
     do {
         cout << "\n========================================\n";
         cout << "   Memory Simulator (IPT + TLB + LRU)   \n";
@@ -397,9 +596,13 @@ int main() {
         cout << "1. Run TLB/LRU Batch Test\n";
         cout << "2. Interactive Mode\n";
         cout << "3. Visualize Translation\n";
+        cout << "4. Context-Switch Test (Flush vs ASID)\n";
+        cout << "5. Per-CPU Frame Cache Test\n";
+        cout << "6. TLB Prefetch Test\n";
+        cout << "7. Select TLB Predictor (now: " << TLBPrefetch_Name(System_TLB_Prefetch.kind) << ")\n";
         cout << "0. Exit\n";
         cout << "Choice: ";
-        cin >> choice;
+        if (!(cin >> choice)) break;
 
         if (choice == 1) {
             run_batch_test();
@@ -427,8 +630,34 @@ int main() {
             Visualize_Translation(pid, hex_to_int(hexVA));
             Print_TLB_State();
         }
+        else if (choice == 4) {
+            run_context_switch_test();
+        }
+        else if (choice == 5) {
+            run_frame_cache_test();
+        }
+        else if (choice == 6) {
+            run_tlb_prefetch_test();
+        }
+        else if (choice == 7) {
+            int kind;
+            cout << "Predictor (0=none 1=sequential 2=stride 3=distance): ";
+            if (cin >> kind && kind >= TLB_PF_NONE && kind <= TLB_PF_DISTANCE) {
+                TLBPrefetch_Init(&System_TLB_Prefetch, (TLBPrefetchKind)kind, TLB_PF_BUFFER);
+                cout << "TLB predictor: " << TLBPrefetch_Name(System_TLB_Prefetch.kind) << "\n";
+            } else {
+                cout << "Invalid predictor.\n";
+            }
+        }
 
     } while (choice != 0);
 
+    if (Interval_Stats != nullptr) {
+        if (!Interval_Stats->write(argv[1])) {
+            cerr << "Error: failed writing " << argv[1] << endl;
+            return 1;
+        }
+        cout << "Interval stats written to " << argv[1] << "\n";
+    }
     return 0;
 }
\ No newline at end of file
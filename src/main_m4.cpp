@@ -3,6 +3,9 @@
 #include <vector>
 #include <iomanip>
 #include <climits>
+#include <sstream>
+#include "latency.h"
+#include "stats.h"
 
 using namespace std;
 
@@ -20,8 +23,58 @@ PageDirectory* root_directory;
 Frame ram[PHY_MEM_SIZE];
 int global_clock = 0;
 
+// --- Page Table Accounting ---
+int tables_live = 0;       // Second-level tables currently allocated
+int tables_allocated = 0;  // Total ever allocated
+int tables_reclaimed = 0;  // Freed because their last valid PTE went away
+int evictions = 0;
+int hits = 0;
+int faults = 0;
+int frames_used = 0;
+
+// Interval time series (enabled by passing an output path)
+IntervalStats* interval_stats = nullptr;
+
+void record_interval() {
+    if (interval_stats == nullptr || !interval_stats->due()) return;
+    SimCounters c;
+    c.accesses = global_clock;
+    c.hits = hits;
+    c.faults = faults;
+    c.evictions = evictions;
+    c.page_table_bytes = sizeof(PageDirectory) + tables_live * sizeof(PageTable);
+    c.resident_pages = frames_used;
+    interval_stats->snapshot(c);
+}
+
+// Messages raised while handling a fault are buffered here and printed
+// once the fault is done, so console I/O stays out of the profiled stages.
+ostringstream event_log;
+
+// --- Helper: Lookup PTE without allocating (Read Path) ---
+PageTableEntry* lookup_pte(uint32_t virtual_addr) {
+    return PD_Lookup(root_directory, virtual_addr);
+}
+
+// --- Helper: Drop one live PTE and free the table once it is empty ---
+void release_pte(int dir_idx, int tbl_idx) {
+    PageTable* pt = root_directory->tables[dir_idx];
+    pt->entries[tbl_idx].valid = false;
+    pt->entries[tbl_idx].frame_number = -1;
+    pt->live_entries--;
+
+    if (pt->live_entries == 0) {
+        delete pt;
+        root_directory->tables[dir_idx] = nullptr;
+        tables_live--;
+        tables_reclaimed++;
+        event_log << "\033[1;36m  [RECLAIM] Page Table for Dir " << dir_idx << " is empty -> freed\033[0m" << endl;
+    }
+}
+
 // --- Helper: Find and Evict the Least Recently Used Frame ---
 int evict_lru() {
+    PROFILE_START(t_evict);
     int min_time = INT_MAX;
     int victim_frame = -1;
 
@@ -43,14 +96,15 @@ int evict_lru() {
     int dir_idx = (old_vpn >> 10) & 0x3FF;  // Extract top 10 bits
     int tbl_idx = old_vpn & 0x3FF;          // Extract next 10 bits
     
+    event_log << "\033[1;33m  [EVICT] Frame " << victim_frame 
+              << " was owning VPN " << old_vpn << " (Time: " << min_time << ")\033[0m" << endl;
+
     // We assume the page table exists because the frame was allocated
     if (root_directory->tables[dir_idx] != nullptr) {
-        root_directory->tables[dir_idx]->entries[tbl_idx].valid = false;
-        root_directory->tables[dir_idx]->entries[tbl_idx].frame_number = -1;
+        release_pte(dir_idx, tbl_idx);
     }
-
-    cout << "\033[1;33m  [EVICT] Frame " << victim_frame 
-         << " was owning VPN " << old_vpn << " (Time: " << min_time << ")\033[0m" << endl;
+    evictions++;
+    PROFILE_NESTED(STAGE_EVICT, t_evict);
 
     // 3. Return the now-empty frame
     return victim_frame;
@@ -61,6 +115,7 @@ int allocate_frame(int vpn) {
     // 1. Try to find a free frame
     for (int i = 0; i < PHY_MEM_SIZE; i++) {
         if (ram[i].is_free) {
+            frames_used++;
             ram[i].is_free = false;
             ram[i].owner_vpn = vpn;
             ram[i].last_access_time = global_clock;
@@ -83,45 +138,63 @@ int allocate_frame(int vpn) {
 int translate_address(uint32_t virtual_addr) {
     global_clock++; // Time ticks on every request
 
-    // Breakdown
-    int dir_index = (virtual_addr >> DIR_SHIFT) & 0x3FF;
-    int table_index = (virtual_addr >> TABLE_SHIFT) & 0x3FF;
     int vpn = (virtual_addr >> 12);
 
     cout << "Time: " << setw(3) << global_clock << " | Req: 0x" << hex << virtual_addr << dec 
          << " (VPN: " << vpn << ") ... ";
 
-    // 1. Check Directory
-    if (root_directory->tables[dir_index] == nullptr) {
-        root_directory->tables[dir_index] = new PageTable();
-    }
+    // 1. Walk without building anything
+    PROFILE_START(t_walk);
+    PageTableEntry* pte = lookup_pte(virtual_addr);
+    PROFILE_STAGE(STAGE_WALK, t_walk);
 
-    PageTable* pt = root_directory->tables[dir_index];
-
-    // 2. Check Page Table (MISS)
-    if (!pt->entries[table_index].valid) {
+    // 2. MISS (no table, or invalid entry)
+    if (pte == nullptr || !pte->valid) {
         cout << "\033[1;31mMISS\033[0m -> "; 
 
+        // Allocate first: eviction may reclaim the very table we are about to use
+        PROFILE_START(t_fault);
+        int evictions_before = evictions;
         int new_frame = allocate_frame(vpn);
-        
-        pt->entries[table_index].frame_number = new_frame;
-        pt->entries[table_index].valid = true;
-        
+
+        if (PD_Map(root_directory, virtual_addr, new_frame)) {
+            tables_live++;
+            tables_allocated++;
+        }
+        PROFILE_STAGE(STAGE_FAULT, t_fault);
+        PROFILE_OUTCOME(evictions > evictions_before ? OUT_MAJOR_FAULT : OUT_MINOR_FAULT);
+        (void)evictions_before;
+        faults++;
+        record_interval();
+
+        cout << event_log.str();
+        event_log.str("");
         cout << "Allocated Frame " << new_frame << endl;
         return new_frame;
     }
 
     // 3. HIT
-    int frame = pt->entries[table_index].frame_number;
+    PROFILE_OUTCOME(OUT_WALK_HIT);
+    int frame = pte->frame_number;
     
     // IMPORTANT: Update timestamp on Frame for LRU to work!
     ram[frame].last_access_time = global_clock;
+    hits++;
+    record_interval();
     
     cout << "\033[1;32mHIT\033[0m  -> Frame " << frame << endl;
     return frame;
 }
 
-int main() {
+// Usage: paging_sim_m4 [stats.csv|stats.json] [interval]
+int main(int argc, char** argv) {
+    u64 every = 16;
+    if (argc > 2 && !Parse_Interval(argv[2], &every)) {
+        fprintf(stderr, "Error: interval must be a positive integer, got %s\n", argv[2]);
+        return 1;
+    }
+    if (argc > 1) interval_stats = new IntervalStats(every);
+
     printf("=== Milestone 4: Multi-Level Paging + LRU ===\n");
     printf("RAM Size: %d Frames\n\n", PHY_MEM_SIZE);
     
@@ -145,5 +218,36 @@ int main() {
     printf("\n--- Phase 3: Force Eviction ---\n");
     translate_address(64 * 4096);
 
+    // 4. Scan one page per directory slot (4 MB stride)
+    // Every access needs its own Page Table. Without reclamation this would
+    // leave 128 tables (1.5 MB) resident; with it, live tables track RAM.
+    printf("\n--- Phase 4: Sparse Scan (Page Table Reclamation) ---\n");
+    for (int i = 1; i <= 128; i++) {
+        translate_address((uint32_t)i << DIR_SHIFT);
+    }
+
+    // 5. A lookup that misses must not build a table
+    printf("\n--- Phase 5: Read-Only Lookup ---\n");
+    int before = tables_live;
+    PageTableEntry* probe = lookup_pte(0xFFC00000);
+    printf("Lookup 0xFFC00000 -> %s, tables before/after: %d/%d\n",
+           (probe && probe->valid) ? "HIT" : "MISS", before, tables_live);
+
+    printf("\n=== Page Table Stats ===\n");
+    printf("Tables Live:      %d (%zu bytes)\n", tables_live, tables_live * sizeof(PageTable));
+    printf("Tables Allocated: %d\n", tables_allocated);
+    printf("Tables Reclaimed: %d\n", tables_reclaimed);
+
+    fflush(stdout);
+    PROFILE_REPORT();
+
+    if (interval_stats != nullptr) {
+        if (!interval_stats->write(argv[1])) {
+            fprintf(stderr, "Error: failed writing %s\n", argv[1]);
+            return 1;
+        }
+        printf("Interval stats written to %s\n", argv[1]);
+    }
+
     return 0;
 }
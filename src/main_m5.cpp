@@ -0,0 +1,270 @@
+#include "buddy.h"
+#include "paging_v2.h"
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+using namespace std;
+
+/* ===================================================
+   SECTION 1: System Configuration (64-Bit Arch)
+   =================================================== */
+const long long pageSize = 4096;
+const long long MEM_SIZE = 131072;
+const long long TOTAL_FRAMES = (MEM_SIZE / pageSize); // 32 Frames
+const int RAM_SIZE = MEM_SIZE;
+
+// Error Codes
+const int ERR_PAGE_FAULT = -2;
+
+/* ===================================================
+   SECTION 2: Physical Memory (Hardware)
+   =================================================== */
+unsigned char RAM[RAM_SIZE];
+
+BuddyAllocator physical_memory;
+
+/* ===================================================
+   SECTION 3: The Page Tree (CR3 Register in x86)
+   =================================================== */
+PageTreeV2* Root_Tree = new PageTreeV2;
+
+/* ===================================================
+   SECTION 4: The Engine
+   =================================================== */
+
+// 1. The Builder
+bool Handle_Page_FaultV2(u64 VA) {
+    long long frame = allocate_frame(&physical_memory);
+    if (frame < 0) return false; // Out of Memory
+
+    Map_PageV2(Root_Tree, VA, frame);
+    return true;
+}
+
+// 2. The Translator (read path, builds nothing on a miss)
+long long TranslateV2(u64 VA) {
+    PageTableEntryV2* leaf = Lookup_PTE_V2(Root_Tree, VA);
+    if (leaf == nullptr) return ERR_PAGE_FAULT;
+    return Calculate_PA(leaf->frame_number, get_offsetV2(VA));
+}
+
+// 3. The Destroyer (frees the frame and any tables left empty)
+void Unmap(u64 VA) {
+    u64 before = Root_Tree->nodes_live;
+    long long frame = Unmap_PageV2(Root_Tree, VA);
+    if (frame < 0) {
+        cout << "Not mapped, nothing to do.\n";
+        return;
+    }
+    free_frame(&physical_memory, (int)frame);
+    cout << "Unmapped -> Frame " << frame << " freed, "
+         << (before - Root_Tree->nodes_live) << " table(s) reclaimed\n";
+}
+
+// 4. Contiguous buffer (DMA): a naturally aligned block of 2^k frames
+void Allocate_Contiguous(u64 pages) {
+    int order = Buddy_Order_For(pages);
+    long long first = Buddy_Alloc(&physical_memory, order);
+    if (first < 0) {
+        cout << "[DMA] No free block of " << (1ULL << order) << " contiguous frames\n";
+        return;
+    }
+    cout << "[DMA] " << (1ULL << order) << " contiguous frames: " << first << "-" << first + (1LL << order) - 1
+         << " (PA 0x" << hex << (first * pageSize) << dec << ")\n";
+}
+
+/* ===================================================
+   SECTION 5: Interface (Store/Load)
+   =================================================== */
+
+void Store(u64 VA, char data) {
+    long long PA = TranslateV2(VA);
+
+    if (PA == ERR_PAGE_FAULT) {
+        // Handle Fault
+        bool fixed = Handle_Page_FaultV2(VA);
+        if (!fixed) {
+            cout << "OOM Error!\n";
+            return;
+        }
+        PA = TranslateV2(VA); // Retry
+    }
+
+    if (PA >= 0) {
+        RAM[PA] = data;
+        cout << "Stored '" << data << "' at PA 0x" << hex << PA << dec << "\n";
+    }
+}
+
+char Load(u64 VA) {
+    long long PA = TranslateV2(VA);
+
+    if (PA < 0) {
+        cout << "Page Fault at VA 0x" << hex << VA << dec << " (read of an unmapped page)\n";
+        return '?';
+    }
+    cout << "Loaded '" << RAM[PA] << "' from PA 0x" << hex << PA << dec << "\n";
+    return RAM[PA];
+}
+
+u64 hex_to_int(string hex) {
+    return stoull(hex, nullptr, 16);
+}
+
+void Print_Tree_Stats() {
+    cout << "   [TABLES] Live: " << Root_Tree->nodes_live
+         << " (" << Tree_BytesV2(Root_Tree) << " bytes)"
+         << " | Allocated: " << Root_Tree->nodes_allocated
+         << " | Reclaimed: " << Root_Tree->nodes_reclaimed << "\n";
+}
+
+/* ===================================================
+   SECTION 6: Main
+   =================================================== */
+
+void Visualize_Translation_V2(u64 VA) {
+    // Standard x86-64 Paging Names for display
+    const string LevelNames[] = {
+            "Level 4 (PML4)",
+            "Level 3 (PDPT)",
+            "Level 2 (PD)  ",
+            "Level 1 (PT)  "
+    };
+
+    cout << "\n   [VISUALIZER 64-bit] Inspecting VA: 0x" << hex << VA << dec << "\n";
+    cout << "   ==========================================================\n";
+
+    PageTableV2* current_table = Root_Tree->root;
+
+    for (int i = 0; i < LEVELS; ++i) {
+        u64 idx = get_indexV2(VA, i);
+
+        cout << "   ├── " << LevelNames[i] << " | Index: " << idx
+             << " | Live Entries: " << current_table->live_entries << "\n";
+
+        if (current_table->entries[idx].is_valid == false) {
+            cout << "   │   └── [X] Entry Invalid (Page Fault would occur here)\n";
+            cout << "   ==========================================================\n";
+            return;
+        }
+
+        if (i == LEVELS - 1) {
+            u64 PFN = current_table->entries[idx].frame_number;
+            u64 PA = Calculate_PA(PFN, get_offsetV2(VA));
+
+            cout << "   │   └── [OK] Leaf Found -> Frame Number: " << PFN << "\n";
+            cout << "   │\n";
+            cout << "   └── [RESULT] Physical Address: 0x" << hex << PA << dec << "\n";
+        }
+        else {
+            cout << "   │   └── [OK] Table Found -> Going deeper...\n";
+            current_table = current_table->entries[idx].next_level_page_table;
+        }
+    }
+    cout << "   ==========================================================\n";
+}
+
+void System_Boot() {
+    Buddy_Init(&physical_memory, TOTAL_FRAMES);
+    cout << "System Booted. Ready for 64-bit Paging.\n";
+}
+
+void run_batch_test() {
+    cout << "\n=== RUNNING 64-BIT BATCH TEST ===\n";
+    ofstream out("input.txt");
+    // Write, read back, then unmap: once both pages are gone every table
+    // except the root must have been given back. The DMA buffer stays, so
+    // the freed frames can only merge up to the block beside it.
+    out << "W 0x1000 A\n"
+           "R 0x1000\n"
+           "D 8\n"                  // 8 contiguous frames (count in decimal)
+           "W 0x1A00200300 B\n"     // Huge 64-bit address (PML4 slot shared, builds 2 tables)
+           "R 0x1A00200300\n"
+           "R 0x9999999999\n"       // Fault test (must not build tables)
+           "U 0x1A00200300\n"       // Unmap -> reclaim its PD/PT
+           "R 0x1A00200300\n"
+           "U 0x1000\n";
+    out.close();
+
+    ifstream inputFile("input.txt");
+    if (!inputFile.is_open()) return;
+
+    string virtual_address_HEX;
+    char operation, data;
+
+    while (inputFile >> operation >> virtual_address_HEX) {
+        cout << "\nCOMMAND: " << operation << " " << virtual_address_HEX << "\n";
+        if (operation == 'D') {
+            Allocate_Contiguous(stoull(virtual_address_HEX));
+            continue;
+        }
+        u64 VA = hex_to_int(virtual_address_HEX);
+
+        if (operation == 'W') {
+            inputFile >> data;
+            Store(VA, data);
+        } else if (operation == 'U') {
+            Unmap(VA);
+        } else {
+            Load(VA);
+        }
+        Print_Tree_Stats();
+    }
+    inputFile.close();
+    Buddy_Print(&physical_memory, cout);
+    cout << "=== BATCH TEST COMPLETE ===\n\n";
+}
+
+int main() {
+    System_Boot();
+
+    int choice = 0;
+    do {
+        cout << "\n========================================\n";
+        cout << "   M5 N-Level Paging Explorer (64-bit)  \n";
+        cout << "========================================\n";
+        cout << "1. Run Batch Test (input.txt)\n";
+        cout << "2. Interactive Mode (Store/Load/Unmap)\n";
+        cout << "3. Visualize Translation (Tree Walk)\n";
+        cout << "0. Exit\n";
+        cout << "Choice: ";
+        if (!(cin >> choice)) break;
+
+        if (choice == 1) {
+            run_batch_test();
+        }
+        else if (choice == 2) {
+            string hexAddr;
+            char op, val;
+            cout << "Enter Operation (W/R/U): ";
+            cin >> op;
+            cout << "Enter Address (Hex): ";
+            cin >> hexAddr;
+
+            u64 VA = hex_to_int(hexAddr);
+
+            if (op == 'W' || op == 'w') {
+                cout << "Enter Value (Char): ";
+                cin >> val;
+                Store(VA, val);
+            } else if (op == 'U' || op == 'u') {
+                Unmap(VA);
+            } else {
+                Load(VA);
+            }
+            Print_Tree_Stats();
+        }
+        else if (choice == 3) {
+            string hexAddr;
+            cout << "Enter Address to Inspect (Hex): ";
+            cin >> hexAddr;
+
+            Visualize_Translation_V2(hex_to_int(hexAddr));
+        }
+
+    } while (choice != 0);
+
+    return 0;
+}
@@ -0,0 +1,508 @@
+#include "mglru.h"
+#include "mmu.h"
+#include "replacement.h"
+#include "replay.h"
+#include "sampling.h"
+#include "snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/* ===================================================
+   Trace Replay CLI
+   ===================================================
+   Usage: paging_replay key=value ...
+     backend=linear|2level|4level|adaptive|inverted|clustered (4level)
+     trace=FILE|-      replay a trace file; otherwise generate:
+     count=N           records from the workload generator (1000000)
+     pattern=... seed=... pages=... (all paging_tracegen options)
+     frames=N          physical frames                   (1024)
+     policy=lru|arc|2q|lirs|mglru[,...]  replacement policy; a list
+                       replays the same trace once per policy and compares
+                       them (lru); mglru needs backend=2level|4level
+     mglru_interval=N  MGLRU aging walk every N accesses, 0 = only when
+                       eviction runs short of generations (0)
+     vpages=N          per-process VPN limit, linear only (1048576)
+     tlb=N             TLB entries, 0 = no TLB           (64)
+     tlb_mode=flush|asid   asids=N                       (asid, 8)
+     tlb_coalesce=N    CoLT-style entries covering up to N contiguous
+                       VPN->PFN pages, N a power of two <= 64 (1 = off)
+     data=0|1          model frame contents               (0)
+     fault_around=N    map the aligned N-page block from page cache (0)
+     readahead=MAX [ra_init=N]  adaptive sequential readahead     (0, 4)
+     ksm=PAGES [ksm_interval=N] same-page merging: scan PAGES frames
+                              every N accesses (0, 1000); implies data=1
+     zswap=PERCENT     compressed pool for evicted pages, capped at
+                       PERCENT of RAM, over a swap device (0); implies data=1
+     tiers=FRAMES:NS,...   NUMA nodes / memory tiers, nearest first; sets frames
+     placement=first_touch|interleave   (first_touch)
+     tier_interval=N tier_sample=N hot=N   migration daemon period (10000, 0 = off),
+                       1-in-N access sampling (64), samples to promote (2)
+     cache=KIB:WAYS,...  L1/L2/LLC caches, nearest first (off), fed by
+                       data accesses and page-walk PTE loads
+     cache_line=N      cache line bytes                  (64)
+     stats=FILE  interval=N   interval time series (CSV or .json)
+     save=FILE [save_at=N]    snapshot the state after N records (end)
+     restore=FILE             resume from a snapshot; its backend/frames/
+                              TLB/cache settings (and generator spec) win
+     sample=PERIOD [sample_warmup=N] [sample_window=N]
+                       sampled mode: functional fast-forward, detailed
+                       windows, extrapolated totals with 95% CIs
+     cost=HIT,WALK,MINOR,MAJOR  modelled ns per outcome (1,20,500,5000) */
+
+/* ===================================================
+   SECTION 1: Configuration
+   =================================================== */
+struct ReplayConfig {
+    string backend = "4level";
+    string trace_path;
+    WorkloadSpec spec;
+    u64 count = 1000000;
+    u64 frames = 1024;
+    vector<string> policies = {"lru"};
+    string policy = "lru"; // The one being run
+    u64 mglru_interval = 0;
+    u64 vpages = 1 << 20;
+    int tlb_entries = 64;
+    TLBMode tlb_mode = TLB_ASID_TAGGED;
+    u64 tlb_coalesce = 1;
+    int asids = 8;
+    bool data = false;
+    u64 fault_around = 0;
+    u64 readahead = 0;
+    u64 ra_init = 4;
+    u64 ksm = 0;
+    u64 ksm_interval = 1000;
+    u64 zswap = 0;
+    vector<u64> tier_frames;
+    vector<double> tier_latency;
+    TieringDaemon tiering; // Daemon settings
+    vector<CacheGeometry> caches;
+    u64 cache_line = 64;
+    string stats_path;
+    u64 interval = 10000;
+    string save_path;
+    u64 save_at = ~0ULL;
+    string restore_path;
+    bool sampled = false;
+    SamplingConfig sampling;
+    CostModel cost;
+};
+
+void Print_Usage() {
+    cout << "Usage: paging_replay [backend=linear|2level|4level|adaptive|inverted|clustered] [trace=FILE|-]\n"
+            "                     [count=N pattern=... (paging_tracegen options)]\n"
+            "                     [frames=N] [policy=lru|arc|2q|lirs|mglru[,...]] [mglru_interval=N]\n"
+            "                     [vpages=N] [tlb=N] [tlb_mode=flush|asid] [asids=N] [tlb_coalesce=N]\n"
+            "                     [data=0|1] [fault_around=N] [readahead=MAX] [ra_init=N]\n"
+            "                     [ksm=PAGES] [ksm_interval=N] [zswap=PERCENT]\n"
+            "                     [tiers=FRAMES:NS,...] [placement=first_touch|interleave]\n"
+            "                     [tier_interval=N] [tier_sample=N] [hot=N]\n"
+            "                     [cache=KIB:WAYS,...] [cache_line=N]\n"
+            "                     [stats=FILE] [interval=N]\n"
+            "                     [save=FILE] [save_at=N] [restore=FILE]\n"
+            "                     [sample=PERIOD] [sample_warmup=N] [sample_window=N] [cost=H,W,MINOR,MAJOR]\n";
+}
+
+/* ===================================================
+   SECTION 2: Run one instantiation
+   =================================================== */
+
+// One row per policy when several are compared on the same trace
+struct PolicyRow {
+    string name;
+    MmuStats stats;
+    double secs;
+};
+vector<PolicyRow> Policy_Rows;
+
+// Policy-specific knobs and report lines; most policies have none
+template <class P>
+void Set_Policy_Options(P&, const ReplayConfig&) {}
+void Set_Policy_Options(MglruPolicy& p, const ReplayConfig& cfg) { p.interval = cfg.mglru_interval; }
+
+template <class P>
+void Print_Policy_Stats(const P&, const MmuStats&) {}
+void Print_Policy_Stats(const MglruPolicy& p, const MmuStats& s) {
+    const MglruStats& m = p.stats;
+    printf("MGLRU:             %llu walks (%llu on demand), %llu young PTEs, %llu rescued at eviction, "
+           "%llu promoted, %llu generations now\n",
+           (unsigned long long)m.walks, (unsigned long long)m.on_demand, (unsigned long long)m.young,
+           (unsigned long long)m.rescued, (unsigned long long)m.promoted, (unsigned long long)p.generations());
+    printf("MGLRU Walk Cost:   %.2f ms (%llu tables, %llu PTEs read + %llu rmap checks; %.1f PTEs per eviction, "
+           "%llu TLB shootdowns)\n",
+           m.walk_ns / 1e6, (unsigned long long)m.tables, (unsigned long long)m.ptes,
+           (unsigned long long)m.rmap_checks, s.evictions ? (double)(m.ptes + m.rmap_checks) / s.evictions : 0.0,
+           (unsigned long long)m.shootdowns);
+}
+
+void Print_TLB_Coalescing(const NoTLB&) {}
+void Print_TLB_Coalescing(const TLB& t) {
+    if (t.max_run <= 1) return;
+    const TLBCoalesceStats& c = t.coalesce;
+    printf("TLB Coalescing:    up to %llu pages, %llu fills, %.2f%% coalesced, %.2f pages per fill (%llu PTE probes)\n",
+           (unsigned long long)t.max_run, (unsigned long long)c.fills, c.fills ? 100.0 * c.coalesced / c.fills : 0.0,
+           c.fills ? (double)c.pages_filled / c.fills : 0.0, (unsigned long long)c.probes);
+    printf("TLB Reach:         %llu pages in %llu entries\n", (unsigned long long)t.reach(),
+           (unsigned long long)t.array.size());
+}
+
+// Per level: misses by kind, then where the page tables sit
+template <class Backend>
+void Print_Caches(const CacheHierarchy& h) {
+    if (!h.enabled()) return;
+    const u64 n = h.levels.size();
+    for (u64 i = 0; i < n; ++i) {
+        const CacheLevel& l = h.levels[i];
+        const CacheLevelStats& c = l.stats;
+        printf("Cache %-4s %6llu KiB %2llu-way: data %llu / %llu misses (%.2f%%), walk %llu / %llu misses (%.2f%%)\n",
+               Cache_Level_Name(i, n).c_str(), (unsigned long long)((l.lines() << h.line_shift) >> 10),
+               (unsigned long long)l.ways, (unsigned long long)c.misses[CACHE_DATA],
+               (unsigned long long)c.accesses[CACHE_DATA],
+               c.accesses[CACHE_DATA] ? 100.0 * c.misses[CACHE_DATA] / c.accesses[CACHE_DATA] : 0.0,
+               (unsigned long long)c.misses[CACHE_WALK], (unsigned long long)c.accesses[CACHE_WALK],
+               c.accesses[CACHE_WALK] ? 100.0 * c.misses[CACHE_WALK] / c.accesses[CACHE_WALK] : 0.0);
+    }
+    const CacheLevel& llc = h.levels[n - 1];
+    const u64 refs = h.levels[0].stats.accesses[CACHE_DATA] + h.levels[0].stats.accesses[CACHE_WALK];
+    printf("LLC Page Tables:   %llu of %llu lines now (%.2f%%), %.2f%% on average; %llu data lines evicted by PTE fills\n",
+           (unsigned long long)llc.walk_lines, (unsigned long long)llc.lines(), 100.0 * llc.walk_lines / llc.lines(),
+           refs ? 100.0 * llc.stats.walk_line_sum / refs / llc.lines() : 0.0, (unsigned long long)llc.stats.stolen);
+    if (!Has_Walk_Refs<Backend>::value) {
+        printf("Walk References:   not modelled for this backend\n");
+        return;
+    }
+    const u64 loads = h.levels[0].stats.accesses[CACHE_WALK];
+    printf("Walk References:   %llu PTE loads in %llu walks (%.2f per walk), %llu from memory\n",
+           (unsigned long long)loads, (unsigned long long)h.walks, h.walks ? (double)loads / h.walks : 0.0,
+           (unsigned long long)llc.stats.misses[CACHE_WALK]);
+}
+
+template <class M>
+void Print_Report(const ReplayConfig& cfg, const M& mmu, double secs) {
+    const MmuStats& s = mmu.stats;
+    double acc = s.accesses ? (double)s.accesses : 1.0;
+    printf("\n=== REPLAY (backend=%s, frames=%llu, policy=%s, tlb=%d %s) ===\n", cfg.backend.c_str(),
+           (unsigned long long)cfg.frames, mmu.frames.policy.name(), cfg.tlb_entries,
+           cfg.tlb_entries == 0 ? "" : (cfg.tlb_mode == TLB_FLUSH_ON_SWITCH ? "flush" : "asid"));
+    printf("Accesses:          %llu\n", (unsigned long long)s.accesses);
+    printf("TLB Hits:          %llu (%.2f%%)\n", (unsigned long long)s.tlb_hits, 100.0 * s.tlb_hits / acc);
+    printf("Walk Hits:         %llu\n", (unsigned long long)s.walk_hits);
+    printf("Page Faults:       %llu (%.2f%%)\n", (unsigned long long)s.faults, 100.0 * s.faults / acc);
+    printf("Evictions:         %llu (write-backs: %llu)\n", (unsigned long long)s.evictions,
+           (unsigned long long)s.writebacks);
+    printf("Seg Faults:        %llu\n", (unsigned long long)s.seg_faults);
+    if (s.prefetched) {
+        printf("Prefetched:        %llu (used: %llu, wasted: %llu)\n", (unsigned long long)s.prefetched,
+               (unsigned long long)s.prefetch_hits, (unsigned long long)s.prefetch_wasted);
+    }
+    if (s.forks) {
+        printf("Forks:             %llu (COW faults: %llu, frames saved by sharing: %llu)\n",
+               (unsigned long long)s.forks, (unsigned long long)s.cow_faults,
+               (unsigned long long)(mmu.frames.mappings() - mmu.frames.used()));
+    }
+    if (mmu.ksm.enabled()) {
+        const KsmStats& k = mmu.ksm.stats;
+        printf("KSM:               %llu merged (scanned: %llu in %llu passes, shared now: %llu frames saved)\n",
+               (unsigned long long)k.merged, (unsigned long long)k.scanned, (unsigned long long)k.passes,
+               (unsigned long long)(mmu.frames.mappings() - mmu.frames.used()));
+        printf("KSM Scan Cost:     %.2f ms (%.0f ns/page, %llu hashed, %llu compared)\n", k.scan_ns / 1e6,
+               k.scanned ? (double)k.scan_ns / k.scanned : 0.0, (unsigned long long)k.hashed,
+               (unsigned long long)k.compared);
+    }
+    if (mmu.zswap.enabled()) {
+        const ZswapStats& z = mmu.zswap.stats;
+        double tpn = profile_ticks_per_ns();
+        printf("Zswap:             %llu stored (rejected: %llu), %llu pool hits, %llu swap-ins, %llu written back\n",
+               (unsigned long long)z.stored, (unsigned long long)z.rejected, (unsigned long long)z.pool_hits,
+               (unsigned long long)z.swap_ins, (unsigned long long)z.writebacks);
+        printf("Zswap Pool:        %llu / %llu KiB (peak %llu KiB), ratio %.2fx\n",
+               (unsigned long long)(mmu.zswap.pool_bytes >> 10), (unsigned long long)(mmu.zswap.limit >> 10),
+               (unsigned long long)(z.peak_bytes >> 10), z.bytes_out ? (double)z.bytes_in / z.bytes_out : 0.0);
+        printf("Zswap Latency:     compress p50 %.0f ns p99 %.0f ns, decompress p50 %.0f ns p99 %.0f ns\n",
+               z.compress.percentile(0.5) / tpn, z.compress.percentile(0.99) / tpn,
+               z.decompress.percentile(0.5) / tpn, z.decompress.percentile(0.99) / tpn);
+    }
+    if (mmu.tiers.enabled()) {
+        const TierStats& t = mmu.tiers.stats;
+        u64 total = 0;
+        for (u64 a : t.accesses) total += a;
+        for (u64 n = 0; n < mmu.frames.nodes(); ++n) {
+            printf("Node %-2llu (%4.0f ns):   %llu / %llu frames, %llu accesses (%.2f%%)\n", (unsigned long long)n,
+                   mmu.tiers.latency_ns[n], (unsigned long long)(mmu.frames.node_frames(n) - mmu.frames.node_free(n)),
+                   (unsigned long long)mmu.frames.node_frames(n), (unsigned long long)t.accesses[n],
+                   total ? 100.0 * t.accesses[n] / total : 0.0);
+        }
+        printf("Memory Cost:       %.1f ns/access (promotions: %llu, demotions: %llu)\n", mmu.tiers.average_ns(),
+               (unsigned long long)t.promotions, (unsigned long long)t.demotions);
+    }
+    Print_Policy_Stats(mmu.frames.policy, s);
+    if (s.functional) printf("Functional:        %llu (TLB not modelled)\n", (unsigned long long)s.functional);
+    printf("Context Switches:  %llu\n", (unsigned long long)mmu.tlb.stats.switches);
+    Print_TLB_Coalescing(mmu.tlb);
+    Print_Caches<typename std::decay<decltype(mmu.table)>::type>(mmu.caches);
+    printf("Page-Table Bytes:  %llu\n", (unsigned long long)mmu.table.table_bytes());
+    printf("Resident Frames:   %llu / %llu\n", (unsigned long long)mmu.frames.used(),
+           (unsigned long long)mmu.frames.capacity());
+    printf("Elapsed:           %.1f ms (%.2f M accesses/s)\n", secs * 1000.0,
+           secs > 0 ? s.accesses / secs / 1e6 : 0.0);
+}
+
+template <class Backend, class Tlb, class Policy>
+int Run(const ReplayConfig& cfg, const Tlb& tlb) {
+    Mmu<Backend, Tlb, Policy> mmu(cfg.frames, tlb, cfg.vpages);
+    if (cfg.data) mmu.enable_data();
+    Set_Policy_Options(mmu.frames.policy, cfg);
+    mmu.prefetch.fault_around = cfg.fault_around;
+    mmu.prefetch.ra_max = cfg.readahead;
+    mmu.prefetch.ra_init = cfg.ra_init;
+    mmu.ksm.pages = cfg.ksm;
+    mmu.ksm.interval = cfg.ksm_interval;
+    mmu.zswap.limit = cfg.frames * MMU_PAGE_SIZE * cfg.zswap / 100;
+    if (!cfg.tier_frames.empty()) {
+        mmu.tiers = cfg.tiering;
+        mmu.set_tiers(cfg.tier_frames, cfg.tier_latency);
+    }
+    if (!cfg.caches.empty() && !Cache_Init(&mmu.caches, cfg.caches, cfg.cache_line)) {
+        cerr << "Error: each cache level needs a power-of-two number of sets\n";
+        return 1;
+    }
+    IntervalStats stats(cfg.interval);
+    IntervalStats* sink = cfg.stats_path.empty() ? nullptr : &stats;
+
+    // Resume point (all zero for a fresh run)
+    SnapshotTrace pos;
+    pos.generated = cfg.trace_path.empty();
+    pos.spec = cfg.spec;
+    if (!cfg.restore_path.empty()) {
+        auto t0 = chrono::steady_clock::now();
+        SnapshotReader snap;
+        string error;
+        if (!snap.open(cfg.restore_path) || !Load_Snapshot(snap, mmu, &pos, &error)) {
+            cerr << "Error: cannot restore " << cfg.restore_path << (error.empty() ? "" : ": ") << error << endl;
+            return 1;
+        }
+        printf("Restored %s in %.2f ms (resuming at record %llu)\n", cfg.restore_path.c_str(),
+               chrono::duration<double>(chrono::steady_clock::now() - t0).count() * 1000.0,
+               (unsigned long long)pos.records);
+    }
+
+    auto save = [&](u64 records, u64 file_offset) {
+        SnapshotTrace at = pos;
+        at.records = records;
+        at.file_offset = file_offset;
+        if (!Save_Snapshot(cfg.save_path, mmu, at, cfg.vpages)) {
+            cerr << "Error: failed writing " << cfg.save_path << endl;
+            return false;
+        }
+        printf("Snapshot of %llu records written to %s\n", (unsigned long long)records, cfg.save_path.c_str());
+        return true;
+    };
+    bool want_save = !cfg.save_path.empty();
+
+    // One loop for any driver; returns false on an I/O error
+    auto drive = [&](auto& driver) {
+        if (!pos.generated) {
+            TraceFileReader in(cfg.trace_path);
+            if (!in.is_open() || (pos.records && !in.seek(pos.file_offset))) {
+                cerr << "Error: cannot open trace " << cfg.trace_path << endl;
+                return false;
+            }
+            u64 done = pos.records;
+            if (want_save && cfg.save_at > done) {
+                done += Replay_Trace_File(driver, in, sink, cfg.save_at - done);
+                if (!save(done, in.offset())) return false;
+                want_save = false;
+            }
+            done += Replay_Trace_File(driver, in, sink);
+            return !want_save || save(done, in.offset());
+        }
+        WorkloadGenerator gen(pos.spec);
+        gen.skip(pos.records);
+        u64 done = pos.records;
+        u64 total = cfg.count > done ? cfg.count : done;
+        if (want_save && cfg.save_at > done && cfg.save_at < total) {
+            done += Replay_Generator(driver, gen, cfg.save_at - done, sink);
+            if (!save(done, 0)) return false;
+            want_save = false;
+        }
+        done += Replay_Generator(driver, gen, total - done, sink);
+        return !want_save || save(done, 0);
+    };
+
+    auto start = chrono::steady_clock::now();
+    SampledReplay<Mmu<Backend, Tlb, Policy>> sampler(mmu, cfg.sampling, cfg.cost);
+    if (cfg.sampled) {
+        if (!drive(sampler)) return 1;
+        sampler.finish();
+    } else {
+        DetailedReplay<Mmu<Backend, Tlb, Policy>> detailed(mmu);
+        if (!drive(detailed)) return 1;
+    }
+    mmu.tlb.close_burst();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    Print_Report(cfg, mmu, secs);
+    Policy_Rows.push_back({Policy::name(), mmu.stats, secs});
+    if (cfg.sampled) sampler.print();
+    PROFILE_REPORT();
+    if (sink != nullptr && !stats.write(cfg.stats_path)) {
+        cerr << "Error: failed writing " << cfg.stats_path << endl;
+        return 1;
+    }
+    return 0;
+}
+
+template <class Backend, class Policy>
+int Run_Policy(const ReplayConfig& cfg) {
+    if (cfg.tlb_entries == 0) return Run<Backend, NoTLB, Policy>(cfg, NoTLB());
+    TLB tlb(cfg.tlb_entries, cfg.tlb_mode, cfg.asids);
+    tlb.set_coalescing(cfg.tlb_coalesce);
+    return Run<Backend, TLB, Policy>(cfg, tlb);
+}
+
+template <class Backend>
+int Run_Backend(const ReplayConfig& cfg) {
+    if (cfg.policy == "arc")  return Run_Policy<Backend, ArcPolicy>(cfg);
+    if (cfg.policy == "2q")   return Run_Policy<Backend, TwoQPolicy>(cfg);
+    if (cfg.policy == "lirs") return Run_Policy<Backend, LirsPolicy>(cfg);
+    if (cfg.policy == "mglru") {
+        if constexpr (Has_Age_Walk<Backend>::value) return Run_Policy<Backend, MglruPolicy>(cfg);
+        cerr << "Error: policy=mglru needs a backend with accessed bits (2level, 4level)\n";
+        return 1;
+    }
+    return Run_Policy<Backend, LruPolicy>(cfg);
+}
+
+int Run_Config(const ReplayConfig& cfg) {
+    if (cfg.backend == "linear")    return Run_Backend<LinearBackend>(cfg);
+    if (cfg.backend == "2level")    return Run_Backend<TwoLevelBackend>(cfg);
+    if (cfg.backend == "4level")    return Run_Backend<FourLevelBackend>(cfg);
+    if (cfg.backend == "adaptive")  return Run_Backend<AdaptiveBackend>(cfg);
+    if (cfg.backend == "inverted")  return Run_Backend<InvertedBackend>(cfg);
+    if (cfg.backend == "clustered") return Run_Backend<ClusteredBackend>(cfg);
+    cerr << "Unknown backend '" << cfg.backend << "'\n";
+    return 1;
+}
+
+void Print_Policy_Comparison() {
+    printf("\n=== POLICY COMPARISON ===\n");
+    printf("%-8s %12s %8s %12s %12s %10s\n", "Policy", "Faults", "Fault%", "Evictions", "Write-backs", "Elapsed");
+    for (const PolicyRow& r : Policy_Rows) {
+        double acc = r.stats.accesses ? (double)r.stats.accesses : 1.0;
+        printf("%-8s %12llu %7.2f%% %12llu %12llu %8.1f ms\n", r.name.c_str(), (unsigned long long)r.stats.faults,
+               100.0 * r.stats.faults / acc, (unsigned long long)r.stats.evictions,
+               (unsigned long long)r.stats.writebacks, r.secs * 1000.0);
+    }
+}
+
+/* ===================================================
+   SECTION 3: Main (pick the instantiation once)
+   =================================================== */
+int main(int argc, char** argv) {
+    ReplayConfig cfg;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == string::npos) { Print_Usage(); return 1; }
+        string key = arg.substr(0, eq), val = arg.substr(eq + 1);
+
+        if (key == "backend")        cfg.backend = val;
+        else if (key == "trace")     cfg.trace_path = val;
+        else if (key == "count")     cfg.count = stoull(val);
+        else if (key == "frames")    cfg.frames = stoull(val);
+        else if (key == "policy") {
+            cfg.policies.clear();
+            for (size_t at = 0; at <= val.size();) {
+                size_t end = val.find(',', at);
+                if (end == string::npos) end = val.size();
+                string name = val.substr(at, end - at);
+                if (name != "lru" && name != "arc" && name != "2q" && name != "lirs" && name != "mglru") { Print_Usage(); return 1; }
+                cfg.policies.push_back(name);
+                at = end + 1;
+            }
+        }
+        else if (key == "mglru_interval") cfg.mglru_interval = stoull(val);
+        else if (key == "vpages")    cfg.vpages = stoull(val);
+        else if (key == "tlb")       cfg.tlb_entries = stoi(val);
+        else if (key == "tlb_mode")  cfg.tlb_mode = (val == "flush") ? TLB_FLUSH_ON_SWITCH : TLB_ASID_TAGGED;
+        else if (key == "asids")     cfg.asids = stoi(val);
+        else if (key == "tlb_coalesce") cfg.tlb_coalesce = stoull(val);
+        else if (key == "data")      cfg.data = (val != "0");
+        else if (key == "fault_around") cfg.fault_around = stoull(val);
+        else if (key == "readahead") cfg.readahead = stoull(val);
+        else if (key == "ra_init")   cfg.ra_init = stoull(val);
+        else if (key == "ksm")       cfg.ksm = stoull(val);
+        else if (key == "ksm_interval") cfg.ksm_interval = stoull(val);
+        else if (key == "zswap")     cfg.zswap = stoull(val);
+        else if (key == "tiers") {
+            if (!Parse_Tiers(val, &cfg.tier_frames, &cfg.tier_latency)) { Print_Usage(); return 1; }
+        }
+        else if (key == "placement") {
+            if (val != "first_touch" && val != "interleave") { Print_Usage(); return 1; }
+            cfg.tiering.placement = val == "interleave" ? PLACE_INTERLEAVE : PLACE_FIRST_TOUCH;
+        }
+        else if (key == "tier_interval") cfg.tiering.interval = stoull(val);
+        else if (key == "tier_sample") cfg.tiering.sample = stoull(val);
+        else if (key == "hot")       cfg.tiering.hot = stoull(val);
+        else if (key == "cache") {
+            if (!Parse_Caches(val, &cfg.caches)) { Print_Usage(); return 1; }
+        }
+        else if (key == "cache_line") cfg.cache_line = stoull(val);
+        else if (key == "stats")     cfg.stats_path = val;
+        else if (key == "interval")  cfg.interval = stoull(val);
+        else if (key == "save")      cfg.save_path = val;
+        else if (key == "save_at")   cfg.save_at = stoull(val);
+        else if (key == "restore")   cfg.restore_path = val;
+        else if (key == "sample")    { cfg.sampled = true; cfg.sampling.period = stoull(val); }
+        else if (key == "sample_warmup") cfg.sampling.warmup = stoull(val);
+        else if (key == "sample_window") cfg.sampling.window = stoull(val);
+        else if (key == "cost") {
+            if (sscanf(val.c_str(), "%lf,%lf,%lf,%lf", &cfg.cost.tlb_hit, &cfg.cost.walk,
+                       &cfg.cost.minor_fault, &cfg.cost.major_fault) != 4) { Print_Usage(); return 1; }
+        }
+        else if (!Parse_Workload_Option(key, val, cfg.spec)) { Print_Usage(); return 1; }
+    }
+    // A restored run takes its machine configuration from the snapshot
+    if (!cfg.restore_path.empty()) {
+        SnapshotReader snap;
+        SnapshotConfig sc;
+        if (!snap.open(cfg.restore_path) || !Read_Snapshot_Config(snap, &sc)) {
+            cerr << "Error: " << cfg.restore_path << " is not a snapshot\n";
+            return 1;
+        }
+        cfg.backend = sc.backend;
+        cfg.frames = sc.frames;
+        cfg.vpages = sc.virtual_pages;
+        cfg.tlb_entries = (int)sc.tlb_entries;
+        cfg.tlb_mode = (TLBMode)sc.tlb_mode;
+        cfg.asids = (int)sc.asids;
+        cfg.data = sc.data != 0;
+        cfg.policies.assign(1, sc.policy);
+        cfg.tier_frames.clear(); // The node layout comes from the snapshot too
+        cfg.caches.clear();      // ... and the caches, with their contents
+    }
+    if (!cfg.tier_frames.empty()) {
+        cfg.frames = 0;
+        for (u64 n : cfg.tier_frames) cfg.frames += n;
+    }
+    if (cfg.ksm || cfg.zswap) cfg.data = true; // Both work on frame contents
+    if (cfg.frames == 0 || cfg.ksm_interval == 0 || cfg.tiering.sample == 0 || (cfg.fault_around & (cfg.fault_around - 1)) ||
+        cfg.tlb_coalesce == 0 || cfg.tlb_coalesce > 64 || (cfg.tlb_coalesce & (cfg.tlb_coalesce - 1)) ||
+        cfg.cache_line < 8 || cfg.cache_line > 4096 || (cfg.cache_line & (cfg.cache_line - 1))) { Print_Usage(); return 1; }
+
+    // One output file per run: a comparison only reports
+    if (cfg.policies.size() > 1 && (!cfg.save_path.empty() || !cfg.stats_path.empty())) { Print_Usage(); return 1; }
+
+    for (const string& name : cfg.policies) {
+        cfg.policy = name;
+        int rc = Run_Config(cfg);
+        if (rc != 0) return rc;
+    }
+    if (cfg.policies.size() > 1) Print_Policy_Comparison();
+    return 0;
+}
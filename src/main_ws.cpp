@@ -0,0 +1,144 @@
+#include "stats.h"
+#include "trace.h"
+#include "wsclock.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* ===================================================
+   SECTION 1: Configuration (overridable from argv)
+   =================================================== */
+int NUM_FRAMES = 32;
+u64 TAU = 100;             // Working-set window, in each process's references
+u64 SAMPLE_INTERVAL = 50;  // Global references between time-series samples
+
+/* ===================================================
+   SECTION 2: Built-in Trace
+   =================================================== */
+
+// Two tenants: PID 1 loops over 8 hot pages, then widens to 20 (phase
+// change); PID 2 streams through 64 pages it never reuses.
+void Write_Demo_Trace(const string& path) {
+    ofstream out(path);
+    for (int t = 0; t < 600; ++t) {
+        int hot = (t < 300) ? (t % 8) : (t % 20);
+        out << "R 1 0x" << hex << (0x10000 + hot * 0x1000) << dec << "\n";
+        out << "W 2 0x" << hex << (0x400000 + (t % 64) * 0x1000) << dec << " x\n";
+    }
+}
+
+/* ===================================================
+   SECTION 3: Report
+   =================================================== */
+struct Sample {
+    u64 t;
+    u64 pid;
+    u64 wss;
+    int resident;
+};
+
+u64 percentile(vector<u64> v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t idx = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[idx];
+}
+
+void Print_Report(const WSClock& clock, const WorkingSetTracker& ws, const vector<Sample>& samples) {
+    cout << "\n=== WSClock STATS (frames=" << NUM_FRAMES << ", tau=" << TAU << ") ===\n";
+    cout << "Hits:             " << clock.stats.hits << "\n";
+    cout << "Faults:           " << clock.stats.faults << "\n";
+    cout << "Evictions:        " << clock.stats.evictions
+         << " (forced: " << clock.stats.evictions_forced << ")\n";
+    cout << "Write-backs:      " << clock.stats.writebacks << "\n";
+    cout << "Hand Steps:       " << clock.stats.hand_steps << "\n";
+
+    map<u64, vector<u64>> per_pid;
+    for (const Sample& s : samples) per_pid[s.pid].push_back(s.wss);
+
+    cout << "\n=== WORKING SET SIZES (pages) ===\n";
+    cout << "PID   Samples   p50   p95   Peak   Resident\n";
+    for (auto& entry : per_pid) {
+        u64 pid = entry.first;
+        cout << pid << "     " << entry.second.size()
+             << "        " << percentile(entry.second, 0.50)
+             << "     " << percentile(entry.second, 0.95)
+             << "     " << ws.peak(pid)
+             << "      " << clock.resident_pages(pid) << "\n";
+    }
+    cout << "(Size a tenant's memory limit from its p95 or peak W(t, tau).)\n";
+}
+
+/* ===================================================
+   SECTION 4: Main
+   =================================================== */
+
+// Usage: paging_sim_ws [trace] [frames] [tau] [interval] [csv] [stats.csv|stats.json]
+int main(int argc, char** argv) {
+    string trace_path = (argc > 1) ? argv[1] : "input_ws.txt";
+    if (argc > 2) NUM_FRAMES = stoi(argv[2]);
+    if (argc > 3) TAU = stoull(argv[3]);
+    if (argc > 4) SAMPLE_INTERVAL = stoull(argv[4]);
+    string csv_path = (argc > 5) ? argv[5] : "working_set.csv";
+    string stats_path = (argc > 6) ? argv[6] : "";
+
+    if (argc <= 1) Write_Demo_Trace(trace_path);
+
+    ifstream inputFile(trace_path);
+    if (!inputFile.is_open()) {
+        cerr << "Error: cannot open trace " << trace_path << endl;
+        return 1;
+    }
+
+    WSClock clock(NUM_FRAMES, TAU);
+    WorkingSetTracker ws(TAU);
+    vector<Sample> samples;
+    IntervalStats interval_stats(SAMPLE_INTERVAL);
+
+    TraceRecord rec;
+    u64 t = 0;
+    while (Read_Trace_Record(inputFile, rec)) {
+        if (rec.op != 'R' && rec.op != 'W') continue;
+        u64 vpn = get_trace_vpn(rec);
+
+        clock.access(rec.pid, vpn, rec.op == 'W');
+        ws.access(rec.pid, vpn);
+        t++;
+
+        if (interval_stats.due()) {
+            for (auto& p : ws.procs) {
+                samples.push_back({t, p.first, ws.size(p.first), clock.resident_pages(p.first)});
+            }
+            SimCounters c;
+            c.accesses = t;
+            c.hits = clock.stats.hits;
+            c.faults = clock.stats.faults;
+            c.evictions = clock.stats.evictions;
+            c.resident_pages = clock.resident.size();
+            interval_stats.snapshot(c);
+        }
+    }
+    inputFile.close();
+
+    ofstream csv(csv_path);
+    csv << "t,pid,wss,resident\n";
+    for (const Sample& s : samples) {
+        csv << s.t << "," << s.pid << "," << s.wss << "," << s.resident << "\n";
+    }
+    csv.close();
+
+    Print_Report(clock, ws, samples);
+    if (!stats_path.empty() && !interval_stats.write(stats_path)) {
+        cerr << "Error: failed writing " << stats_path << endl;
+        return 1;
+    }
+    cout << "\nTime series written to " << csv_path << " (" << samples.size() << " rows)";
+    if (!stats_path.empty()) cout << " and " << stats_path;
+    cout << "\n";
+    return 0;
+}
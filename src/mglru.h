@@ -0,0 +1,258 @@
+#ifndef MGLRU_H
+#define MGLRU_H
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Multi-Generational LRU (MGLRU-style)
+   ===================================================
+   No recency list is kept up to date on accesses. The hardware sets
+   the accessed bit of a PTE when a walk loads it (backends.h), and
+   resident frames are binned into generations by sequence number,
+   min_seq (oldest) .. max_seq (youngest), at most MGLRU_MAX_GENS:
+
+     fault      the new page joins the youngest generation; its PTE
+                starts old, so pages mapped by fault-around or
+                readahead only turn young once actually walked
+     aging      max_seq++, then walk every page table: each PTE with
+                its accessed bit set is cleared, its TLB entry shot
+                down (so a page that keeps hitting in the TLB sets the
+                bit again on its next walk), and its frame moves to the
+                new youngest generation. Runs when eviction is down to
+                fewer than MGLRU_MIN_GENS generations, and every
+                `interval` accesses if set
+     eviction   from the tail of the oldest non-empty generation, but
+                a frame there with a young PTE (referenced since the
+                last walk) is cleared and promoted instead, as the
+                kernel does when it checks a folio's mappings through
+                the reverse map; at most MGLRU_RESCUE_SCAN per fault
+
+   With MGLRU_MAX_GENS generations alive, aging first folds the oldest
+   one into the next (an O(1) splice; frames below min_seq count as
+   min_seq). The walk cost (tables and PTEs read, shootdowns, host
+   time) is what buys the approximation; compare the fault counts with
+   policy=lru on the same trace to see what it costs in accuracy.
+
+   Needs a backend with accessed bits (2level, 4level).                 */
+
+const int MGLRU_MAX_GENS = 4;
+const int MGLRU_MIN_GENS = 2;
+const int MGLRU_RESCUE_SCAN = 32;
+
+struct MglruStats {
+    u64 walks = 0;        // Aging walks
+    u64 on_demand = 0;    // ... started because eviction ran short of generations
+    u64 tables = 0;       // Page-table pages read
+    u64 ptes = 0;         // PTEs read
+    u64 young = 0;        // Accessed bits harvested by walks
+    u64 promoted = 0;     // Frames moved to a younger generation
+    u64 rmap_checks = 0;  // PTEs tested at eviction time
+    u64 rescued = 0;      // ... found young: promoted instead of evicted
+    u64 folds = 0;        // Oldest generation merged into the next
+    u64 shootdowns = 0;   // TLB entries dropped with a cleared bit
+    u64 walk_ns = 0;      // Host time spent walking
+};
+
+struct MglruPolicy {
+    static const char* name() { return "mglru"; }
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    std::vector<uint32_t> prev, next; // One list per generation, head = youngest
+    uint32_t head[MGLRU_MAX_GENS];
+    uint32_t tail[MGLRU_MAX_GENS];
+    u64 size[MGLRU_MAX_GENS];
+    std::vector<u64> seq;             // Per frame: generation it joined
+    u64 min_seq = 0;
+    u64 max_seq = MGLRU_MIN_GENS - 1;
+    u64 interval = 0;                 // Accesses between periodic walks; 0 = on demand only
+    u64 since = 0;
+    MglruStats stats;
+
+    void init(u64 n) {
+        prev.assign(n, NIL);
+        next.assign(n, NIL);
+        seq.assign(n, 0);
+        for (int g = 0; g < MGLRU_MAX_GENS; ++g) {
+            head[g] = tail[g] = NIL;
+            size[g] = 0;
+        }
+    }
+
+    inline void on_insert(u64 frame, u64, u64) {
+        seq[frame] = max_seq;
+        push_front(gen(max_seq), (uint32_t)frame);
+    }
+
+    // Recency comes from the accessed bits, not from here
+    inline void on_access(u64) {}
+
+    inline void on_remove(u64 frame) { unlink(gen_of(frame), (uint32_t)frame); }
+
+    inline u64 victim() {
+        advance_min_seq();
+        int g = gen(min_seq);
+        uint32_t f = tail[g];
+        unlink(g, f);
+        return f;
+    }
+
+    // Oldest generation from its tail, then each younger one
+    inline u64 coldest() const {
+        for (u64 s = min_seq; s <= max_seq; ++s) {
+            if (tail[gen(s)] != NIL) return tail[gen(s)];
+        }
+        return NIL;
+    }
+    inline u64 warmer(u64 frame) const {
+        if (prev[frame] != NIL) return prev[frame];
+        for (u64 s = (seq[frame] > min_seq ? seq[frame] : min_seq) + 1; s <= max_seq; ++s) {
+            if (tail[gen(s)] != NIL) return tail[gen(s)];
+        }
+        return NIL;
+    }
+
+    inline void on_move(u64 from, u64 to) {
+        uint32_t f = (uint32_t)from, t = (uint32_t)to;
+        int g = gen_of(f);
+        prev[t] = prev[f];
+        next[t] = next[f];
+        if (prev[t] != NIL) next[prev[t]] = t; else head[g] = t;
+        if (next[t] != NIL) prev[next[t]] = t; else tail[g] = t;
+        prev[f] = next[f] = NIL;
+        seq[t] = seq[f];
+    }
+
+    // --- Aging (driven by Mglru_Age) ---
+
+    // True if eviction would have to take from the youngest generation
+    bool needs_aging() {
+        advance_min_seq();
+        return max_seq - min_seq + 1 < (u64)MGLRU_MIN_GENS;
+    }
+
+    inline bool due() {
+        if (interval == 0 || ++since < interval) return false;
+        since = 0;
+        return true;
+    }
+
+    // Opens a new youngest generation, folding the oldest if all are taken
+    void inc_max_seq() {
+        if (max_seq - min_seq + 1 == (u64)MGLRU_MAX_GENS) {
+            int from = gen(min_seq), to = gen(min_seq + 1);
+            if (size[from] > 0) { // Older frames go to the victim end
+                if (tail[to] == NIL) head[to] = head[from];
+                else {
+                    next[tail[to]] = head[from];
+                    prev[head[from]] = tail[to];
+                }
+                tail[to] = tail[from];
+                size[to] += size[from];
+                head[from] = tail[from] = NIL;
+                size[from] = 0;
+            }
+            min_seq++;
+            stats.folds++;
+        }
+        max_seq++;
+    }
+
+    // A frame seen young by the walk joins the youngest generation
+    inline void promote(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        int g = gen_of(f);
+        if (g == gen(max_seq)) return;
+        unlink(g, f);
+        seq[f] = max_seq;
+        push_front(gen(max_seq), f);
+        stats.promoted++;
+    }
+
+    u64 generations() const { return max_seq - min_seq + 1; }
+    u64 gen_size(u64 s) const { return size[gen(s)]; }
+
+private:
+    static inline int gen(u64 s) { return (int)(s % MGLRU_MAX_GENS); }
+    inline int gen_of(u64 frame) const { return gen(seq[frame] > min_seq ? seq[frame] : min_seq); }
+
+    inline void advance_min_seq() {
+        while (min_seq < max_seq && size[gen(min_seq)] == 0) min_seq++;
+    }
+
+    inline void push_front(int g, uint32_t f) {
+        prev[f] = NIL;
+        next[f] = head[g];
+        if (head[g] != NIL) prev[head[g]] = f;
+        head[g] = f;
+        if (tail[g] == NIL) tail[g] = f;
+        size[g]++;
+    }
+
+    inline void unlink(int g, uint32_t f) {
+        if (prev[f] != NIL) next[prev[f]] = next[f]; else head[g] = next[f];
+        if (next[f] != NIL) prev[next[f]] = prev[f]; else tail[g] = prev[f];
+        prev[f] = next[f] = NIL;
+        size[g]--;
+    }
+};
+
+// Backends with PTE accessed bits provide age_walk()
+struct Mglru_No_Young {
+    void operator()(u64, u64, u64) const {}
+};
+template <class B, class = void>
+struct Has_Age_Walk : std::false_type {};
+template <class B>
+struct Has_Age_Walk<B, decltype(std::declval<B&>().age_walk(Mglru_No_Young(), (u64*)nullptr, (u64*)nullptr))>
+    : std::true_type {};
+
+// Before an eviction: promotes frames at the victim end whose PTEs were
+// referenced since the last walk, until one is not (or the scan limit)
+template <class M>
+void Mglru_Rescue(M& mmu) {
+    MglruPolicy& p = mmu.frames.policy;
+    for (int n = 0; n < MGLRU_RESCUE_SCAN; ++n) {
+        u64 f = p.coldest();
+        if (f == MglruPolicy::NIL) return;
+        bool young = false;
+        mmu.frames.for_each_mapping(f, [&](u64 pid, u64 vpn) {
+            p.stats.rmap_checks++;
+            if (!mmu.table.clear_accessed(pid, vpn)) return;
+            mmu.tlb.invalidate(pid, vpn);
+            p.stats.shootdowns++;
+            young = true;
+        });
+        if (!young) return;
+        p.stats.rescued++;
+        p.promote(f);
+        if (p.needs_aging()) return; // Everything left is young: let the walk sort it
+    }
+}
+
+// One aging walk over every page table of the MMU
+template <class M>
+void Mglru_Age(M& mmu) {
+    MglruPolicy& p = mmu.frames.policy;
+    auto t0 = std::chrono::steady_clock::now();
+    p.inc_max_seq();
+    p.stats.walks++;
+    const u64 frames = mmu.frames.capacity();
+    mmu.table.age_walk(
+        [&](u64 pid, u64 vpn, u64 pfn) {
+            p.stats.young++;
+            p.stats.shootdowns++;
+            mmu.tlb.invalidate(pid, vpn);
+            if (pfn < frames && mmu.frames.frames[pfn].in_use) p.promote(pfn);
+        },
+        &p.stats.tables, &p.stats.ptes);
+    p.stats.walk_ns += (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - t0).count();
+}
+
+#endif
@@ -0,0 +1,510 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include "backends.h"
+#include "cache.h"
+#include "frame_alloc.h"
+#include "ksm.h"
+#include "latency.h"
+#include "mglru.h"
+#include "prefetch.h"
+#include "stats.h"
+#include "tiering.h"
+#include "tlb.h"
+#include "zswap.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   MMU: TLB + page-table backend + frame manager
+   ===================================================
+   Mmu<Backend, Tlb, Policy> is assembled at compile time; every call
+   on the translation path is inlined into the driver's loop.
+
+   translate(pid, va, write):
+     1. TLB lookup (tagged by the running process)
+     2. miss -> backend walk
+     3. not mapped -> fault: take a frame from the frame manager; if it
+        had to evict, unmap the victim from its owner's table and shoot
+        its TLB entry down; then map the new page.
+
+   Frame contents are only modelled when enable_data() is called.
+
+   Functional mode (set_functional) is the fast-forward model used by
+   sampled simulation: no TLB lookup or fill, only mappings, faults and
+   frame recency. Evictions still shoot down TLB entries, so switching
+   back to detailed mode never sees a stale translation.
+
+   With a coalescing TLB (TLB::set_coalescing) every fill reads the
+   neighbouring PTEs through the backend's peek() and installs the
+   whole contiguous VPN -> PFN run as one entry.
+
+   Faults can bring in more than one page: see prefetch.h for
+   fault-around and readahead. Speculative pages are mapped but not
+   put in the TLB.
+
+   fork(parent, child) maps every resident page of the parent into the
+   child on the same frame. A frame with more than one mapping is
+   copy-on-write: the first write through any of them copies it into a
+   private frame (a COW fault). Evicting a shared frame unmaps it from
+   every process via the frame manager's reverse map.
+
+   With a zswap pool (zswap.h) evicted contents are compressed on the
+   way out and a fault on the page restores them; without one, a page
+   faulted back in starts zeroed.
+
+   Physical memory can be split into NUMA nodes or tiers with their
+   own latencies (set_tiers, tiering.h): new pages are placed by the
+   node policy and every access is charged its node's latency.
+
+   With a cache hierarchy (cache.h, Cache_Init on `caches`) every
+   detailed access sends its physical address through the caches, and
+   every TLB miss first sends the PTE loads of its walk, on backends
+   that provide walk_refs().
+
+   tick() is called by the replay driver after each access and runs
+   background work: the same-page merging scanner (ksm.h) and the
+   tier migration daemon (tiering.h), if set.
+
+   With MglruPolicy on a backend that keeps accessed bits, the MMU
+   runs the aging walks (mglru.h): on demand when a fault finds memory
+   full and the policy short of generations, and periodically from
+   tick() if an interval is set.                                       */
+
+const u64 MMU_PAGE_SHIFT = 12;
+const u64 MMU_PAGE_SIZE = 1ULL << MMU_PAGE_SHIFT;
+
+// Stands in for the TLB when only page-table walks should be measured
+struct NoTLB {
+    TLBSwitchStats stats;
+    TLBCoalesceStats coalesce;
+    static constexpr u64 max_run = 1;
+    inline long long lookup(u64) { return -1; }
+    inline void update(u64, u64) {}
+    inline void fill(u64, u64, u64) {}
+    inline void invalidate(u64, u64) {}
+    inline void context_switch(u64) {}
+    inline void record(bool) {}
+    inline void close_burst() {}
+};
+
+struct MmuStats {
+    u64 accesses = 0;
+    u64 tlb_hits = 0;
+    u64 tlb_misses = 0;
+    u64 walk_hits = 0;   // TLB miss, page present
+    u64 faults = 0;
+    u64 major_faults = 0; // ... that had to evict a page for their frame
+    u64 evictions = 0;
+    u64 writebacks = 0;  // Evicted frames that were dirty
+    u64 seg_faults = 0;  // VPN outside what the backend can map
+    u64 unmaps = 0;
+    u64 functional = 0;  // Accesses run without the TLB model
+    u64 prefetched = 0;      // Pages mapped by fault-around/readahead
+    u64 prefetch_hits = 0;   // ... later accessed (a fault avoided)
+    u64 prefetch_wasted = 0; // ... evicted or unmapped before any access
+    u64 forks = 0;
+    u64 cow_faults = 0;      // Writes to a shared frame (each copies a page)
+};
+
+template <class Backend, class Tlb = TLB, class Policy = LruPolicy>
+struct Mmu {
+    Backend table;
+    Tlb tlb;
+    FrameManager<Policy> frames;
+    Prefetcher prefetch;
+    KsmScanner ksm;
+    ZswapPool zswap;
+    TieringDaemon tiers;
+    CacheHierarchy caches;
+    MmuStats stats;
+    std::vector<unsigned char> ram; // Frame contents (empty unless enabled)
+
+    Mmu(u64 num_frames, const Tlb& t, u64 virtual_pages = 1ULL << 20)
+        : table(virtual_pages, num_frames), tlb(t), frames(num_frames) {}
+
+    void enable_data() { ram.assign(frames.capacity() * MMU_PAGE_SIZE, 0); }
+
+    // Splits physical memory into nodes (tiering.h); the sizes must add
+    // up to the frame count. Call before the first access.
+    void set_tiers(const std::vector<u64>& node_frames, const std::vector<double>& latency_ns) {
+        frames.set_nodes(node_frames);
+        tiers.latency_ns = latency_ns;
+        tiers.init(frames.capacity());
+    }
+
+    inline void context_switch(u64 pid) { tlb.context_switch(pid); }
+
+    inline void tick() {
+        if (ksm.enabled() && ksm.due()) Ksm_Scan(*this);
+        if (tiers.enabled() && tiers.due()) Tier_Run(*this);
+        if constexpr (AGES) {
+            if (frames.policy.due()) Mglru_Age(*this);
+        }
+    }
+
+    void set_functional(bool on) { functional = on; }
+    bool is_functional() const { return functional; }
+
+    // Physical address, or -1 on a segmentation fault
+    inline long long translate(u64 pid, u64 va, bool write) {
+        long long pa = translate_page(pid, va, write);
+        if (tiers.enabled() && pa >= 0) {
+            u64 frame = (u64)pa >> MMU_PAGE_SHIFT;
+            tiers.on_access(frame, frames.node_of[frame]);
+        }
+        if (caches.enabled() && pa >= 0 && !functional) caches.access((u64)pa, CACHE_DATA);
+        return pa;
+    }
+
+    // Byte access through the MMU; false on a segmentation fault
+    inline bool store(u64 pid, u64 va, unsigned char value) {
+        long long pa = translate(pid, va, true);
+        if (pa < 0) return false;
+        if (!ram.empty()) ram[(u64)pa] = value;
+        return true;
+    }
+
+    inline bool load(u64 pid, u64 va, unsigned char* value) {
+        long long pa = translate(pid, va, false);
+        if (pa < 0) return false;
+        *value = ram.empty() ? 0 : ram[(u64)pa];
+        return true;
+    }
+
+    // Bulk access: splits [va, va + len) at page boundaries, translates
+    // each page once and memcpys the piece. Returns the bytes moved,
+    // short only if a page segfaults.
+    inline u64 read(u64 pid, u64 va, void* buf, u64 len) {
+        unsigned char* out = (unsigned char*)buf;
+        u64 done = 0;
+        while (done < len) {
+            u64 chunk = page_chunk(va + done, len - done);
+            long long pa = translate(pid, va + done, false);
+            if (pa < 0) break;
+            if (ram.empty()) std::memset(out + done, 0, chunk);
+            else std::memcpy(out + done, &ram[(u64)pa], chunk);
+            done += chunk;
+        }
+        return done;
+    }
+
+    inline u64 write(u64 pid, u64 va, const void* buf, u64 len) {
+        const unsigned char* in = (const unsigned char*)buf;
+        u64 done = 0;
+        while (done < len) {
+            u64 chunk = page_chunk(va + done, len - done);
+            long long pa = translate(pid, va + done, true);
+            if (pa < 0) break;
+            if (!ram.empty()) std::memcpy(&ram[(u64)pa], in + done, chunk);
+            done += chunk;
+        }
+        return done;
+    }
+
+    // munmap of one page: frees its frame unless another process still
+    // shares it; false if it was not mapped
+    bool unmap(u64 pid, u64 va) {
+        const u64 vpn = va >> MMU_PAGE_SHIFT;
+        if (zswap.enabled()) zswap.drop(pid, vpn); // A swapped-out copy is garbage now
+        long long frame = table.unmap(pid, vpn);
+        if (frame < 0) return false;
+        tlb.invalidate(pid, vpn);
+        if (!frames.unshare((u64)frame, pid, vpn)) {
+            stats.prefetch_wasted += frames.frames[frame].prefetched;
+            frames.release((u64)frame);
+        }
+        stats.unmaps++;
+        return true;
+    }
+
+    // Maps every resident page of `parent` into `child` on the same
+    // frame; pages in the zswap pool or on swap are copied there for the
+    // child. False (and nothing shared) if the child already has pages.
+    bool fork(u64 parent, u64 child) {
+        if (parent == child) return false;
+        struct Page { u64 frame, vpn; };
+        std::vector<Page> pages;
+        bool child_exists = false;
+        for (u64 f = 0; f < frames.capacity(); ++f) {
+            if (!frames.frames[f].in_use) continue;
+            frames.for_each_mapping(f, [&](u64 pid, u64 vpn) {
+                if (pid == parent) pages.push_back({f, vpn});
+                child_exists |= pid == child;
+            });
+        }
+        if (child_exists || (zswap.enabled() && zswap.holds(child))) return false;
+        for (const Page& p : pages) {
+            if (table.map(child, p.vpn, p.frame)) frames.share(p.frame, child, p.vpn);
+        }
+        if (zswap.enabled()) zswap.clone(parent, child, MMU_PAGE_SIZE);
+        stats.forks++;
+        return true;
+    }
+
+    SimCounters counters() const {
+        SimCounters c;
+        c.accesses = stats.accesses;
+        c.hits = stats.accesses - stats.faults - stats.seg_faults;
+        c.faults = stats.faults;
+        c.evictions = stats.evictions;
+        c.tlb_misses = stats.tlb_misses;
+        c.page_table_bytes = table.table_bytes();
+        c.resident_pages = frames.used();
+        return c;
+    }
+
+private:
+    static constexpr bool AGES = std::is_same<Policy, MglruPolicy>::value && Has_Age_Walk<Backend>::value;
+
+    bool last_fault_evicted = false;
+    bool functional = false;
+
+    // translate() without the tier accounting
+    inline long long translate_page(u64 pid, u64 va, bool write) {
+        const u64 vpn = va >> MMU_PAGE_SHIFT;
+        const u64 offset = va & (MMU_PAGE_SIZE - 1);
+        stats.accesses++;
+        if (functional) return translate_functional(pid, vpn, offset, write);
+        tlb.context_switch(pid); // No-op unless the PID changed
+
+        // 1. TLB
+        PROFILE_START(t_tlb);
+        long long pfn = tlb.lookup(vpn);
+        PROFILE_STAGE(STAGE_TLB_LOOKUP, t_tlb);
+        tlb.record(pfn >= 0);
+        if (pfn >= 0) {
+            stats.tlb_hits++;
+            if (write && frames.frames[pfn].refs > 1) pfn = cow_break(pid, vpn, (u64)pfn, true);
+            else if (frames.touch((u64)pfn, write)) pfn = prefetch_hit(pid, vpn, (u64)pfn, write);
+            PROFILE_OUTCOME(OUT_TLB_HIT);
+            return (pfn << MMU_PAGE_SHIFT) | (long long)offset;
+        }
+        stats.tlb_misses++;
+        if constexpr (Has_Walk_Refs<Backend>::value) {
+            if (caches.enabled()) cache_walk(pid, vpn);
+        }
+
+        // 2. Walk
+        PROFILE_START(t_walk);
+        pfn = table.lookup(pid, vpn);
+        PROFILE_STAGE(STAGE_WALK, t_walk);
+        if (pfn >= 0) {
+            stats.walk_hits++;
+            if (write && frames.frames[pfn].refs > 1) pfn = cow_break(pid, vpn, (u64)pfn, false);
+            else if (frames.touch((u64)pfn, write)) pfn = prefetch_hit(pid, vpn, (u64)pfn, write);
+            tlb_fill(pid, vpn, (u64)pfn);
+            PROFILE_OUTCOME(OUT_WALK_HIT);
+            return (pfn << MMU_PAGE_SHIFT) | (long long)offset;
+        }
+
+        // 3. Fault
+        PROFILE_START(t_fault);
+        long long frame = handle_fault(pid, vpn, write, true);
+        PROFILE_STAGE(STAGE_FAULT, t_fault);
+        if (frame < 0) {
+            PROFILE_DISCARD();
+            return -1;
+        }
+        PROFILE_OUTCOME(last_fault_evicted ? OUT_MAJOR_FAULT : OUT_MINOR_FAULT);
+        return (frame << MMU_PAGE_SHIFT) | (long long)offset;
+    }
+
+    // Bytes from va to the end of its page, capped at `left`
+    static inline u64 page_chunk(u64 va, u64 left) {
+        u64 room = MMU_PAGE_SIZE - (va & (MMU_PAGE_SIZE - 1));
+        return room < left ? room : left;
+    }
+
+    // The walker's PTE loads, through the data caches
+    inline void cache_walk(u64 pid, u64 vpn) {
+        caches.walks++;
+        table.walk_refs(pid, vpn, [&](u64 t, u64 offset) {
+            caches.access(Cache_Table_Address(pid, t, offset), CACHE_WALK);
+        });
+    }
+
+    // With a coalescing TLB the fill reads the PTEs around vpn in its
+    // aligned group and installs the contiguous VPN -> PFN run
+    inline void tlb_fill(u64 pid, u64 vpn, u64 pfn) {
+        if (tlb.max_run <= 1) {
+            tlb.update(vpn, pfn);
+            return;
+        }
+        const u64 group = vpn & ~(tlb.max_run - 1);
+        u64 lo = vpn, hi = vpn + 1;
+        while (lo > group && pfn >= vpn - lo + 1) {
+            tlb.coalesce.probes++;
+            if (table.peek(pid, lo - 1) != (long long)(pfn - (vpn - lo + 1))) break;
+            lo--;
+        }
+        while (hi < group + tlb.max_run) {
+            tlb.coalesce.probes++;
+            if (table.peek(pid, hi) != (long long)(pfn + (hi - vpn))) break;
+            hi++;
+        }
+        tlb.fill(lo, pfn - (vpn - lo), hi - lo);
+    }
+
+    // Fast-forward path: walk, fault if needed, keep recency; no TLB
+    inline long long translate_functional(u64 pid, u64 vpn, u64 offset, bool write) {
+        stats.functional++;
+        long long pfn = table.lookup(pid, vpn);
+        if (pfn >= 0) {
+            if (write && frames.frames[pfn].refs > 1) pfn = cow_break(pid, vpn, (u64)pfn, false);
+            else if (frames.touch((u64)pfn, write)) pfn = prefetch_hit(pid, vpn, (u64)pfn, write);
+        } else if ((pfn = handle_fault(pid, vpn, write, false)) < 0) {
+            return -1;
+        }
+        return (pfn << MMU_PAGE_SHIFT) | (long long)offset;
+    }
+
+    // A frame for a new page, on the node the placement policy prefers
+    inline u64 allocate_frame(u64 pid, u64 vpn, Victim* victim) {
+        if constexpr (AGES) {
+            if (frames.free_frames == 0) {
+                if (frames.policy.needs_aging()) {
+                    frames.policy.stats.on_demand++;
+                    Mglru_Age(*this);
+                }
+                Mglru_Rescue(*this);
+            }
+        }
+        if (!tiers.enabled()) return frames.allocate(pid, vpn, victim);
+        u64 frame = frames.allocate(pid, vpn, victim, tiers.place(vpn));
+        tiers.on_alloc(frame);
+        return frame;
+    }
+
+    // Drop the victim's mappings everywhere they may be cached; `frame`
+    // still holds its contents
+    inline void evict(const Victim& victim, u64 frame) {
+        PROFILE_START(t_evict);
+        if (zswap.enabled() && !ram.empty()) swap_out(victim, frame);
+        table.unmap(victim.pid, victim.vpn);
+        tlb.invalidate(victim.pid, victim.vpn);
+        for (const FrameMapping& m : victim.sharers) {
+            table.unmap(m.pid, m.vpn);
+            tlb.invalidate(m.pid, m.vpn);
+        }
+        stats.evictions++;
+        stats.writebacks += victim.dirty;
+        stats.prefetch_wasted += victim.prefetched;
+        PROFILE_NESTED(STAGE_EVICT, t_evict);
+    }
+
+    inline long long handle_fault(u64 pid, u64 vpn, bool write, bool fill_tlb) {
+        if (!table.in_range(vpn)) {
+            stats.seg_faults++;
+            return -1;
+        }
+
+        // Prefetch first, so its evictions cannot take this page's frame
+        if (prefetch.enabled()) prefetch_after_fault(pid, vpn);
+
+        Victim victim;
+        u64 frame = allocate_frame(pid, vpn, &victim);
+        last_fault_evicted = victim.valid;
+        if (victim.valid) evict(victim, frame);
+        fill_page(pid, vpn, frame);
+
+        if (!table.map(pid, vpn, frame)) {
+            frames.release(frame);
+            stats.seg_faults++;
+            return -1;
+        }
+        stats.faults++;
+        stats.major_faults += victim.valid;
+        frames.frames[frame].dirty |= write; // The insert was the reference
+        if (fill_tlb) tlb_fill(pid, vpn, frame);
+        return (long long)frame;
+    }
+
+    // Evicted contents go to the compressed pool, once per mapping
+    void swap_out(const Victim& victim, u64 frame) {
+        const unsigned char* page = &ram[frame * MMU_PAGE_SIZE];
+        zswap.store(victim.pid, victim.vpn, page, MMU_PAGE_SIZE);
+        for (const FrameMapping& m : victim.sharers) zswap.store(m.pid, m.vpn, page, MMU_PAGE_SIZE);
+    }
+
+    // A newly mapped frame: the page's stored copy if any, else zeros
+    inline void fill_page(u64 pid, u64 vpn, u64 frame) {
+        if (ram.empty()) return;
+        unsigned char* page = &ram[frame * MMU_PAGE_SIZE];
+        if (!zswap.enabled() || !zswap.load(pid, vpn, page, MMU_PAGE_SIZE)) std::memset(page, 0, MMU_PAGE_SIZE);
+    }
+
+    // COW fault: move this mapping off the shared frame onto a copy.
+    // Returns the private frame (its TLB entry is replaced if asked).
+    inline long long cow_break(u64 pid, u64 vpn, u64 shared, bool fill_tlb) {
+        stats.cow_faults++;
+        Victim victim;
+        u64 frame = allocate_frame(pid, vpn, &victim);
+        if (victim.valid) evict(victim, frame);
+        // If the shared frame itself was the victim, every mapping of it
+        // is gone and its contents are already in `frame`
+        if (frame != shared) {
+            if (!ram.empty()) std::memcpy(&ram[frame * MMU_PAGE_SIZE], &ram[shared * MMU_PAGE_SIZE], MMU_PAGE_SIZE);
+            frames.unshare(shared, pid, vpn);
+        } else if (zswap.enabled()) {
+            zswap.drop(pid, vpn); // Stays resident; only the others went out
+        }
+        table.map(pid, vpn, frame);
+        frames.frames[frame].dirty = true;
+        tlb.invalidate(pid, vpn);
+        if (fill_tlb) tlb_fill(pid, vpn, frame);
+        return (long long)frame;
+    }
+
+    /* --- Prefetch (prefetch.h decides, the MMU maps) --- */
+
+    // Runs before the faulting page is mapped. Fault-around only uses
+    // free frames, keeping one for the faulting page.
+    void prefetch_after_fault(u64 pid, u64 vpn) {
+        prefetch.note_resident(pid, vpn);
+        PrefetchRange around = prefetch.around(vpn);
+        for (u64 v = around.start; v < around.start + around.count && frames.free_frames > 1; ++v) {
+            if (v != vpn && prefetch.in_page_cache(pid, v)) prefetch_page(pid, v);
+        }
+        prefetch_range(pid, prefetch.on_fault(pid, vpn));
+    }
+
+    // First touch of a prefetched page: the next readahead window. If
+    // that evicted the page itself (possible under a policy other than
+    // LRU), it faults back in. Returns the page's frame.
+    long long prefetch_hit(u64 pid, u64 vpn, u64 frame, bool write) {
+        stats.prefetch_hits++;
+        prefetch_range(pid, prefetch.on_prefetch_hit(pid, vpn));
+        if (table.peek(pid, vpn) == (long long)frame) return (long long)frame;
+        return handle_fault(pid, vpn, write, false);
+    }
+
+    void prefetch_range(u64 pid, const PrefetchRange& r) {
+        // Never read ahead more than half of memory in one go
+        u64 count = r.count < frames.capacity() / 2 ? r.count : frames.capacity() / 2;
+        for (u64 v = r.start; v < r.start + count; ++v) prefetch_page(pid, v);
+    }
+
+    // Map one page nobody asked for yet; its frame is flagged prefetched
+    void prefetch_page(u64 pid, u64 vpn) {
+        if (!table.in_range(vpn) || table.lookup(pid, vpn) >= 0) return;
+        Victim victim;
+        u64 frame = allocate_frame(pid, vpn, &victim);
+        if (victim.valid) evict(victim, frame);
+        if (!table.map(pid, vpn, frame)) {
+            frames.release(frame);
+            return;
+        }
+        fill_page(pid, vpn, frame);
+        frames.frames[frame].prefetched = true;
+        prefetch.note_resident(pid, vpn);
+        stats.prefetched++;
+    }
+};
+
+#endif
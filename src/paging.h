@@ -1,6 +1,7 @@
 #ifndef PAGING_H
 #define PAGING_H
 
+#include <cstdint>
 #include <vector>
 #include <iostream>
 
@@ -16,12 +17,14 @@ const int TABLE_SHIFT = 12; // Bits 12-21
 struct PageTableEntry {
     int frame_number = -1;
     bool valid = false;
+    bool accessed = false; // Set by the walker, cleared by aging and unmap
     int last_access_time = 0; // For LRU
 };
 
 // Level 2: A single Page Table (Contains 1024 entries)
 struct PageTable {
     PageTableEntry entries[1024];
+    int live_entries = 0; // Valid PTEs; the table is reclaimed when this drops to 0
 };
 
 // Level 1: Page Directory (Contains pointers to Page Tables)
@@ -34,4 +37,50 @@ struct PageDirectory {
     }
 };
 
+// --- Walk Helpers ---
+
+// Read path: returns nullptr when the directory slot has no table; never builds one.
+inline PageTableEntry* PD_Lookup(PageDirectory* dir, uint32_t virtual_addr) {
+    PageTable* pt = dir->tables[(virtual_addr >> DIR_SHIFT) & 0x3FF];
+    if (pt == nullptr) return nullptr;
+    return &pt->entries[(virtual_addr >> TABLE_SHIFT) & 0x3FF];
+}
+
+// Fault path: builds the table if needed and fills the entry.
+// Returns true when a new second-level table had to be allocated.
+inline bool PD_Map(PageDirectory* dir, uint32_t virtual_addr, int frame) {
+    int dir_index = (virtual_addr >> DIR_SHIFT) & 0x3FF;
+    bool created = false;
+    if (dir->tables[dir_index] == nullptr) {
+        dir->tables[dir_index] = new PageTable();
+        created = true;
+    }
+    PageTableEntry& pte = dir->tables[dir_index]->entries[(virtual_addr >> TABLE_SHIFT) & 0x3FF];
+    if (!pte.valid) dir->tables[dir_index]->live_entries++;
+    pte.frame_number = frame;
+    pte.valid = true;
+    return created;
+}
+
+// Unmap path: clears the entry and frees the table once its last PTE is gone.
+// Returns the frame that was mapped (or -1); *table_freed reports a reclaim.
+inline int PD_Unmap(PageDirectory* dir, uint32_t virtual_addr, bool* table_freed) {
+    int dir_index = (virtual_addr >> DIR_SHIFT) & 0x3FF;
+    *table_freed = false;
+    PageTable* pt = dir->tables[dir_index];
+    if (pt == nullptr) return -1;
+    PageTableEntry& pte = pt->entries[(virtual_addr >> TABLE_SHIFT) & 0x3FF];
+    if (!pte.valid) return -1;
+    int frame = pte.frame_number;
+    pte.valid = false;
+    pte.accessed = false;
+    pte.frame_number = -1;
+    if (--pt->live_entries == 0) {
+        delete pt;
+        dir->tables[dir_index] = nullptr;
+        *table_freed = true;
+    }
+    return frame;
+}
+
 #endif
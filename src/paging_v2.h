@@ -0,0 +1,140 @@
+#ifndef PAGING_V2_H
+#define PAGING_V2_H
+
+#include <cstdint>
+
+// Type Alias for cleaner 64-bit code
+typedef uint64_t u64;
+
+// --- Constants for 64-bit Architecture (4 Levels) ---
+// Virtual Address: | PML4 (9) | PDPT (9) | PD (9) | PT (9) | Offset (12) |
+const int LEVELS = 4;
+const int SHIFT_ARR[LEVELS] = {39, 30, 21, 12};
+const u64 ENTRY_MASK = 0x1FF; // 9 bits (511)
+const int ENTRIES_PER_TABLE = 512;
+
+// --- Structures ---
+
+// Forward Declaration
+struct PageTableV2;
+
+// The Generic Entry (Union based)
+struct PageTableEntryV2 {
+    bool is_valid = false;
+    bool accessed = false; // Leaf only: set by the walker, cleared by aging and unmap
+    union {
+        struct PageTableV2* next_level_page_table; // Pointer for Branch nodes
+        unsigned long long frame_number;            // Integer for Leaf nodes
+    };
+};
+
+// The Generic Table (used for every level)
+struct PageTableV2 {
+    PageTableEntryV2 entries[ENTRIES_PER_TABLE];
+    int live_entries = 0; // Valid entries; non-root nodes are reclaimed at 0
+};
+
+// A whole tree plus its memory accounting (CR3 + bookkeeping)
+struct PageTreeV2 {
+    PageTableV2* root = new PageTableV2();
+    u64 nodes_live = 1;      // Root included
+    u64 nodes_allocated = 1;
+    u64 nodes_reclaimed = 0;
+};
+
+// --- Helpers (Bitwise Math) ---
+inline u64 get_indexV2(u64 VA, int level) {
+    return (VA >> SHIFT_ARR[level]) & ENTRY_MASK;
+}
+
+inline u64 get_offsetV2(u64 VA) {
+    return VA & 0xFFF;
+}
+
+inline u64 Calculate_PA(u64 frame, u64 offset) {
+    return (frame << 12) | offset;
+}
+
+inline u64 Tree_BytesV2(const PageTreeV2* tree) {
+    return tree->nodes_live * sizeof(PageTableV2);
+}
+
+// --- Lookup (Read Path): never allocates ---
+// Returns the leaf entry, or nullptr if any level on the way is missing.
+inline PageTableEntryV2* Lookup_PTE_V2(PageTreeV2* tree, u64 VA) {
+    PageTableV2* current_table = tree->root;
+    for (int i = 0; i < LEVELS - 1; ++i) {
+        PageTableEntryV2& e = current_table->entries[get_indexV2(VA, i)];
+        if (!e.is_valid) return nullptr;
+        current_table = e.next_level_page_table;
+    }
+    PageTableEntryV2& leaf = current_table->entries[get_indexV2(VA, LEVELS - 1)];
+    return leaf.is_valid ? &leaf : nullptr;
+}
+
+// --- Map (Builder): creates missing branch nodes, then fills the leaf ---
+inline void Map_PageV2(PageTreeV2* tree, u64 VA, u64 frame) {
+    PageTableV2* current_table = tree->root;
+    for (int i = 0; i < LEVELS - 1; ++i) {
+        PageTableEntryV2& e = current_table->entries[get_indexV2(VA, i)];
+        if (!e.is_valid) {
+            e.next_level_page_table = new PageTableV2();
+            e.is_valid = true;
+            current_table->live_entries++;
+            tree->nodes_live++;
+            tree->nodes_allocated++;
+        }
+        current_table = e.next_level_page_table;
+    }
+
+    PageTableEntryV2& leaf = current_table->entries[get_indexV2(VA, LEVELS - 1)];
+    if (!leaf.is_valid) current_table->live_entries++;
+    leaf.frame_number = frame;
+    leaf.is_valid = true;
+}
+
+// --- Unmap: clears the leaf and frees every node left empty on the path ---
+// Returns the frame that was mapped, or -1 if the page was not present.
+inline long long Unmap_PageV2(PageTreeV2* tree, u64 VA) {
+    PageTableV2* path[LEVELS];
+    PageTableV2* current_table = tree->root;
+
+    for (int i = 0; i < LEVELS; ++i) {
+        path[i] = current_table;
+        PageTableEntryV2& e = current_table->entries[get_indexV2(VA, i)];
+        if (!e.is_valid) return -1;
+        if (i < LEVELS - 1) current_table = e.next_level_page_table;
+    }
+
+    PageTableEntryV2& leaf = path[LEVELS - 1]->entries[get_indexV2(VA, LEVELS - 1)];
+    long long frame = (long long)leaf.frame_number;
+    leaf.is_valid = false;
+    leaf.accessed = false;
+    path[LEVELS - 1]->live_entries--;
+
+    // Walk back up: an empty child is deleted and its parent entry cleared
+    for (int i = LEVELS - 1; i > 0; --i) {
+        if (path[i]->live_entries > 0) break;
+        delete path[i];
+        tree->nodes_live--;
+        tree->nodes_reclaimed++;
+
+        PageTableEntryV2& parent = path[i - 1]->entries[get_indexV2(VA, i - 1)];
+        parent.is_valid = false;
+        parent.next_level_page_table = nullptr;
+        path[i - 1]->live_entries--;
+    }
+    return frame;
+}
+
+// --- Teardown: frees every node below and including `table` ---
+inline void Free_SubtreeV2(PageTableV2* table, int level) {
+    if (level < LEVELS - 1) {
+        for (PageTableEntryV2& e : table->entries) {
+            if (e.is_valid) Free_SubtreeV2(e.next_level_page_table, level + 1);
+        }
+    }
+    delete table;
+}
+
+#endif
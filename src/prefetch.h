@@ -0,0 +1,122 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Fault-Around and Sequential Readahead
+   ===================================================
+   Both decide which extra pages a fault should bring in; the MMU maps
+   them (mmu.h) and flags their frames as prefetched. A prefetched
+   frame that is evicted or unmapped before its first access counts as
+   wasted.
+
+   Fault-around (fault_around = N, a power of two): on a fault, map the
+   other pages of the aligned N-page block that are already in the page
+   cache, i.e. have been resident before (a minor fault, no I/O). It
+   only takes free frames and never evicts.
+
+   Readahead (readahead = max window): per process, a fault on the page
+   after the previous fault (or where the last window ended) is a
+   stream; with fault-around on, anywhere in the next block counts.
+   Its window starts at `ra_init` pages and doubles up to the maximum.
+   The first page of each window is a marker: touching it starts the
+   next window ahead of the stream, so a steady scan stops faulting.
+   A non-sequential fault resets the stream.                          */
+
+struct PrefetchRange {
+    u64 start = 0;
+    u64 count = 0;
+};
+
+struct ReadaheadState {
+    u64 last_fault = ~0ULL;
+    u64 window = 0;     // Current window size (0 = no stream)
+    u64 next = ~0ULL;   // First page not yet read ahead
+    u64 marker = ~0ULL; // Touching this page triggers the next window
+};
+
+struct PrefetchKeyHash {
+    size_t operator()(const std::pair<u64, u64>& k) const {
+        return (size_t)((k.first * 0x9E3779B97F4A7C15ULL) ^ k.second);
+    }
+};
+
+struct Prefetcher {
+    u64 fault_around = 0; // Block size in pages; 0 = off
+    u64 ra_max = 0;       // Max readahead window; 0 = off
+    u64 ra_init = 4;
+
+    std::unordered_map<u64, ReadaheadState> streams;                 // Per PID
+    std::unordered_set<std::pair<u64, u64>, PrefetchKeyHash> cached; // (PID, VPN) seen resident
+
+    bool enabled() const { return fault_around > 1 || ra_max > 0; }
+
+    // Remember that (pid, vpn) has a copy in the page cache
+    inline void note_resident(u64 pid, u64 vpn) {
+        if (fault_around > 1) cached.insert(std::make_pair(pid, vpn));
+    }
+
+    inline bool in_page_cache(u64 pid, u64 vpn) const {
+        return cached.count(std::make_pair(pid, vpn)) != 0;
+    }
+
+    // The aligned block around a faulting page
+    PrefetchRange around(u64 vpn) const {
+        PrefetchRange r;
+        if (fault_around <= 1) return r;
+        r.start = vpn & ~(fault_around - 1);
+        r.count = fault_around;
+        return r;
+    }
+
+    // Synchronous readahead decision for a fault
+    PrefetchRange on_fault(u64 pid, u64 vpn) {
+        PrefetchRange r;
+        if (ra_max == 0) return r;
+        ReadaheadState& st = streams[pid];
+        // With fault-around on, a stream faults once per block, not per page
+        u64 gap = fault_around > 1 ? fault_around : 1;
+        bool sequential = (vpn > st.last_fault && vpn - st.last_fault <= gap) ||
+                          (st.window && vpn == st.next);
+        st.last_fault = vpn;
+        if (!sequential) {
+            st.window = 0;
+            st.marker = st.next = ~0ULL;
+            return r;
+        }
+        st.window = grow(st.window);
+        r.start = vpn + 1;
+        r.count = st.window;
+        st.marker = r.start;
+        st.next = r.start + r.count;
+        return r;
+    }
+
+    // Asynchronous readahead: first touch of a prefetched page
+    PrefetchRange on_prefetch_hit(u64 pid, u64 vpn) {
+        PrefetchRange r;
+        if (ra_max == 0) return r;
+        auto it = streams.find(pid);
+        if (it == streams.end() || it->second.marker != vpn) return r;
+        ReadaheadState& st = it->second;
+        st.window = grow(st.window);
+        r.start = st.next;
+        r.count = st.window;
+        st.marker = r.start;
+        st.next = r.start + r.count;
+        return r;
+    }
+
+private:
+    u64 grow(u64 window) const {
+        if (window == 0) return ra_init < ra_max ? ra_init : ra_max;
+        return window * 2 < ra_max ? window * 2 : ra_max;
+    }
+};
+
+#endif
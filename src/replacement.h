@@ -0,0 +1,502 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Scan-Resistant Replacement Policies (ARC, 2Q, LIRS)
+   ===================================================
+   Drop-in alternatives to LruPolicy for FrameManager (same interface,
+   see frame_alloc.h). Under plain LRU a long sequential scan pushes
+   every hot page out; these keep pages referenced once apart from pages
+   referenced again, and remember recently evicted pages in ghost lists
+   (keys only, no frame) to tell a re-reference from a first touch.
+
+     arc   T1 (seen once) and T2 (seen again) with ghosts B1/B2; a ghost
+           hit moves the T1 target size p toward the list it came from
+     2q    A1in (FIFO, 1/4 of memory) for first touches, Am (LRU) for
+           pages whose key was still in the A1out ghost FIFO
+     lirs  pages ranked by reuse distance: LIR pages (~99% of memory)
+           stay resident, new and far-reuse pages cycle through a small
+           HIR queue; the recency stack keeps non-resident HIR ghosts
+
+   Every operation is O(1) (LIRS stack pruning amortized). Ghosts are
+   capped at one per frame per list, so their memory is bounded by the
+   frame count whatever the trace does.
+
+   The frame to evict is chosen before the faulting page is known, so
+   ARC adapts p when the page is inserted rather than before choosing
+   the victim (the paper's REPLACE(x) tie case on a B2 hit is dropped). */
+
+/* ---------------------------------------------------
+   Building blocks                                                     */
+
+// Intrusive doubly linked list over indices: head = MRU, tail = LRU
+struct PolicyList {
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    std::vector<uint32_t> prev, next;
+    uint32_t head = NIL;
+    uint32_t tail = NIL;
+    u64 size = 0;
+
+    void init(u64 n) {
+        prev.assign(n, NIL);
+        next.assign(n, NIL);
+        head = tail = NIL;
+        size = 0;
+    }
+
+    inline void push_front(uint32_t i) {
+        prev[i] = NIL;
+        next[i] = head;
+        if (head != NIL) prev[head] = i;
+        head = i;
+        if (tail == NIL) tail = i;
+        size++;
+    }
+
+    inline void unlink(uint32_t i) {
+        if (prev[i] != NIL) next[prev[i]] = next[i]; else head = next[i];
+        if (next[i] != NIL) prev[next[i]] = prev[i]; else tail = prev[i];
+        prev[i] = next[i] = NIL;
+        size--;
+    }
+
+    inline void move_front(uint32_t i) {
+        if (head == i) return;
+        unlink(i);
+        push_front(i);
+    }
+
+    // `to` (not linked) takes the place of `from`
+    inline void replace(uint32_t from, uint32_t to) {
+        prev[to] = prev[from];
+        next[to] = next[from];
+        if (prev[to] != NIL) next[prev[to]] = to; else head = to;
+        if (next[to] != NIL) prev[next[to]] = to; else tail = to;
+        prev[from] = next[from] = NIL;
+    }
+};
+
+struct PageKey {
+    u64 pid = 0;
+    u64 vpn = 0;
+    bool operator==(const PageKey& o) const { return pid == o.pid && vpn == o.vpn; }
+};
+
+struct PageKeyHash {
+    size_t operator()(const PageKey& k) const { return (size_t)((k.pid * 0x9E3779B97F4A7C15ULL) ^ k.vpn); }
+};
+
+// Keys of evicted pages in a fixed pool of slots, oldest dropped first
+struct GhostList {
+    PolicyList order;              // Over slots, newest at the head
+    std::vector<PageKey> keys;     // Per slot
+    std::vector<uint32_t> free_slots;
+    std::unordered_map<PageKey, uint32_t, PageKeyHash> index;
+
+    void init(u64 capacity) {
+        order.init(capacity);
+        keys.assign(capacity, PageKey());
+        free_slots.clear();
+        for (u64 s = capacity; s > 0; --s) free_slots.push_back((uint32_t)(s - 1));
+        index.clear();
+        index.reserve(capacity);
+    }
+
+    u64 size() const { return order.size; }
+    u64 capacity() const { return keys.size(); }
+
+    // Slot holding `k`, or NIL
+    inline uint32_t find(const PageKey& k) const {
+        auto it = index.find(k);
+        return it == index.end() ? PolicyList::NIL : it->second;
+    }
+
+    inline void erase_slot(uint32_t slot) {
+        index.erase(keys[slot]);
+        order.unlink(slot);
+        free_slots.push_back(slot);
+    }
+
+    inline bool erase(const PageKey& k) {
+        uint32_t slot = find(k);
+        if (slot == PolicyList::NIL) return false;
+        erase_slot(slot);
+        return true;
+    }
+
+    inline void pop_oldest() { erase_slot(order.tail); }
+
+    // Records `k` as the newest ghost; `dropped` gets the slot it had to
+    // free for it (an older copy of `k` or the oldest ghost), or NIL
+    inline uint32_t push(const PageKey& k, uint32_t* dropped) {
+        *dropped = find(k);
+        if (*dropped != PolicyList::NIL) erase_slot(*dropped);
+        else if (free_slots.empty()) {
+            *dropped = order.tail;
+            pop_oldest();
+        }
+        uint32_t slot = free_slots.back();
+        free_slots.pop_back();
+        keys[slot] = k;
+        index[k] = slot;
+        order.push_front(slot);
+        return slot;
+    }
+
+    inline void push(const PageKey& k) {
+        uint32_t dropped;
+        push(k, &dropped);
+    }
+};
+
+/* ---------------------------------------------------
+   ARC                                                                 */
+struct ArcPolicy {
+    static const char* name() { return "arc"; }
+    static constexpr uint32_t NIL = PolicyList::NIL;
+    enum : uint8_t { NONE, T1, T2 };
+
+    PolicyList t1, t2;         // Resident: referenced once / at least twice
+    GhostList b1, b2;          // Evicted from t1 / t2
+    std::vector<uint8_t> where; // Per frame
+    std::vector<PageKey> page;  // Per frame
+    u64 c = 0;
+    u64 p = 0;                 // Target size of t1
+
+    void init(u64 n) {
+        c = n;
+        p = 0;
+        t1.init(n);
+        t2.init(n);
+        b1.init(n);
+        b2.init(n);
+        where.assign(n, NONE);
+        page.assign(n, PageKey());
+    }
+
+    inline void on_insert(u64 frame, u64 pid, u64 vpn) {
+        uint32_t f = (uint32_t)frame;
+        PageKey k{pid, vpn};
+        page[f] = k;
+        if (b1.find(k) != NIL) {
+            u64 d = b2.size() > b1.size() ? b2.size() / b1.size() : 1;
+            p = p + d < c ? p + d : c;
+            b1.erase(k);
+            t2.push_front(f);
+            where[f] = T2;
+        } else if (b2.find(k) != NIL) {
+            u64 d = b1.size() > b2.size() ? b1.size() / b2.size() : 1;
+            p = p > d ? p - d : 0;
+            b2.erase(k);
+            t2.push_front(f);
+            where[f] = T2;
+        } else {
+            t1.push_front(f);
+            where[f] = T1;
+        }
+        // Directory bounds: |T1| + |B1| <= c, everything <= 2c
+        if (t1.size + b1.size() > c && b1.size() > 0) b1.pop_oldest();
+        if (t1.size + t2.size + b1.size() + b2.size() > 2 * c && b2.size() > 0) b2.pop_oldest();
+    }
+
+    inline void on_access(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (where[f] == T2) {
+            t2.move_front(f);
+        } else if (where[f] == T1) {
+            t1.unlink(f);
+            t2.push_front(f);
+            where[f] = T2;
+        }
+    }
+
+    inline void on_remove(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (where[f] == T1) t1.unlink(f);
+        else if (where[f] == T2) t2.unlink(f);
+        where[f] = NONE;
+    }
+
+    inline u64 victim() {
+        uint32_t f;
+        if (t1.size > 0 && (t1.size > p || t2.size == 0)) {
+            f = t1.tail;
+            t1.unlink(f);
+            b1.push(page[f]);
+        } else {
+            f = t2.tail;
+            t2.unlink(f);
+            b2.push(page[f]);
+        }
+        where[f] = NONE;
+        return f;
+    }
+
+    // Victim end first: t1 from its LRU end, then t2
+    inline u64 coldest() const { return t1.tail != NIL ? t1.tail : t2.tail; }
+    inline u64 warmer(u64 frame) const {
+        if (where[frame] == T2) return t2.prev[frame];
+        return t1.prev[frame] != NIL ? t1.prev[frame] : t2.tail;
+    }
+
+    inline void on_move(u64 from, u64 to) {
+        uint32_t f = (uint32_t)from, t = (uint32_t)to;
+        if (where[f] == T1) t1.replace(f, t);
+        else if (where[f] == T2) t2.replace(f, t);
+        where[t] = where[f];
+        where[f] = NONE;
+        page[t] = page[f];
+    }
+};
+
+/* ---------------------------------------------------
+   2Q (full version: A1in, A1out, Am)                                  */
+struct TwoQPolicy {
+    static const char* name() { return "2q"; }
+    static constexpr uint32_t NIL = PolicyList::NIL;
+    enum : uint8_t { NONE, A1IN, AM };
+
+    PolicyList a1in, am;
+    GhostList a1out;
+    std::vector<uint8_t> where; // Per frame
+    std::vector<PageKey> page;  // Per frame
+    u64 kin = 1;                // A1in target size
+
+    void init(u64 n) {
+        kin = n / 4 ? n / 4 : 1;
+        a1in.init(n);
+        am.init(n);
+        a1out.init(n / 2 ? n / 2 : 1);
+        where.assign(n, NONE);
+        page.assign(n, PageKey());
+    }
+
+    inline void on_insert(u64 frame, u64 pid, u64 vpn) {
+        uint32_t f = (uint32_t)frame;
+        PageKey k{pid, vpn};
+        page[f] = k;
+        if (a1out.erase(k)) {
+            am.push_front(f);
+            where[f] = AM;
+        } else {
+            a1in.push_front(f);
+            where[f] = A1IN;
+        }
+    }
+
+    // Re-references while in A1in are taken as correlated: no promotion
+    inline void on_access(u64 frame) {
+        if (where[frame] == AM) am.move_front((uint32_t)frame);
+    }
+
+    inline void on_remove(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (where[f] == A1IN) a1in.unlink(f);
+        else if (where[f] == AM) am.unlink(f);
+        where[f] = NONE;
+    }
+
+    inline u64 victim() {
+        uint32_t f;
+        if (a1in.size > kin || am.size == 0) {
+            f = a1in.tail;
+            a1in.unlink(f);
+            a1out.push(page[f]);
+        } else {
+            f = am.tail;
+            am.unlink(f);
+        }
+        where[f] = NONE;
+        return f;
+    }
+
+    inline u64 coldest() const { return a1in.tail != NIL ? a1in.tail : am.tail; }
+    inline u64 warmer(u64 frame) const {
+        if (where[frame] == AM) return am.prev[frame];
+        return a1in.prev[frame] != NIL ? a1in.prev[frame] : am.tail;
+    }
+
+    inline void on_move(u64 from, u64 to) {
+        uint32_t f = (uint32_t)from, t = (uint32_t)to;
+        if (where[f] == A1IN) a1in.replace(f, t);
+        else if (where[f] == AM) am.replace(f, t);
+        where[t] = where[f];
+        where[f] = NONE;
+        page[t] = page[f];
+    }
+};
+
+/* ---------------------------------------------------
+   LIRS
+   The stack S holds frames (ids [0, n)) and non-resident HIR ghosts
+   (ids n + slot); its bottom is always an LIR frame. Q holds the
+   resident HIR frames, evicted from its tail.                         */
+struct LirsPolicy {
+    static const char* name() { return "lirs"; }
+    static constexpr uint32_t NIL = PolicyList::NIL;
+    enum : uint8_t { NONE, LIR, HIR };
+
+    PolicyList s;               // Recency stack, top = head
+    PolicyList q;               // Resident HIR frames
+    GhostList ghosts;           // Non-resident HIR pages still in S
+    std::vector<uint8_t> status; // Per frame
+    std::vector<uint8_t> in_s;   // Per frame
+    std::vector<PageKey> page;   // Per frame
+    u64 n = 0;
+    u64 lir = 0;                 // LIR frames now
+    u64 lir_max = 0;             // ... at most (1% of memory left for HIR)
+
+    void init(u64 frames) {
+        n = frames;
+        lir = 0;
+        lir_max = n - (n / 100 ? n / 100 : 1);
+        s.init(2 * n);
+        q.init(n);
+        ghosts.init(n);
+        status.assign(n, NONE);
+        in_s.assign(n, 0);
+        page.assign(n, PageKey());
+    }
+
+    inline void on_insert(u64 frame, u64 pid, u64 vpn) {
+        uint32_t f = (uint32_t)frame;
+        PageKey k{pid, vpn};
+        page[f] = k;
+        uint32_t slot = ghosts.find(k);
+        if (slot != NIL) { // Reused within the stack: its recency beats the bottom LIR
+            s.unlink((uint32_t)n + slot);
+            ghosts.erase_slot(slot);
+        }
+        if (lir < lir_max || slot != NIL) {
+            status[f] = LIR;
+            lir++;
+            push_s(f);
+            if (lir > lir_max) demote_bottom();
+        } else {
+            status[f] = HIR;
+            push_s(f);
+            q.push_front(f);
+        }
+    }
+
+    inline void on_access(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (status[f] == LIR) {
+            bool bottom = s.tail == f;
+            s.move_front(f);
+            if (bottom) prune();
+        } else if (in_s[f]) {
+            s.move_front(f);
+            q.unlink(f);
+            status[f] = LIR;
+            lir++;
+            if (lir > lir_max) demote_bottom();
+        } else {
+            push_s(f);
+            q.move_front(f);
+        }
+    }
+
+    inline void on_remove(u64 frame) {
+        uint32_t f = (uint32_t)frame;
+        if (status[f] == HIR) q.unlink(f);
+        if (status[f] == LIR) lir--;
+        if (in_s[f]) {
+            unlink_s(f);
+            prune();
+        }
+        status[f] = NONE;
+    }
+
+    inline u64 victim() {
+        uint32_t f;
+        if (q.size > 0) {
+            f = q.tail;
+            q.unlink(f);
+            if (in_s[f]) { // Keep its place in S as a ghost
+                uint32_t dropped;
+                uint32_t slot = ghosts.push(page[f], &dropped);
+                if (dropped != NIL) s.unlink((uint32_t)n + dropped);
+                s.replace(f, (uint32_t)n + slot);
+                in_s[f] = 0;
+            }
+        } else {
+            f = s.tail; // Only LIR pages resident
+            unlink_s(f);
+            lir--;
+            prune();
+        }
+        status[f] = NONE;
+        return f;
+    }
+
+    // Victim end first: Q from its tail, then LIR frames from the stack bottom
+    inline u64 coldest() const { return q.tail != NIL ? q.tail : lir_from(s.tail); }
+    inline u64 warmer(u64 frame) const {
+        if (status[frame] == HIR) return q.prev[frame] != NIL ? q.prev[frame] : lir_from(s.tail);
+        return lir_from(s.prev[frame]);
+    }
+
+    inline void on_move(u64 from, u64 to) {
+        uint32_t f = (uint32_t)from, t = (uint32_t)to;
+        if (in_s[f]) s.replace(f, t);
+        if (status[f] == HIR) q.replace(f, t);
+        in_s[t] = in_s[f];
+        in_s[f] = 0;
+        status[t] = status[f];
+        status[f] = NONE;
+        page[t] = page[f];
+    }
+
+private:
+    inline void push_s(uint32_t f) {
+        s.push_front(f);
+        in_s[f] = 1;
+        if (lir == 0) prune(); // No LIR bottom to sit above
+    }
+
+    inline void unlink_s(uint32_t f) {
+        s.unlink(f);
+        in_s[f] = 0;
+    }
+
+    // Pops HIR frames and ghosts off the stack bottom
+    inline void prune() {
+        while (s.tail != NIL) {
+            uint32_t b = s.tail;
+            if (b >= n) {
+                s.unlink(b);
+                ghosts.erase_slot(b - (uint32_t)n);
+            } else if (status[b] != LIR) {
+                unlink_s(b);
+            } else {
+                break;
+            }
+        }
+    }
+
+    // The bottom LIR frame becomes a resident HIR frame
+    inline void demote_bottom() {
+        uint32_t b = s.tail;
+        unlink_s(b);
+        status[b] = HIR;
+        lir--;
+        q.push_front(b);
+        prune();
+    }
+
+    // First LIR frame from stack node `i` toward the top
+    inline u64 lir_from(uint32_t i) const {
+        while (i != NIL && (i >= n || status[i] != LIR)) i = s.prev[i];
+        return i;
+    }
+};
+
+#endif
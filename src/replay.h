@@ -0,0 +1,89 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "stats.h"
+#include "trace.h"
+#include "workload.h"
+
+#include <cstdint>
+#include <cstring>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Replay Driver
+   ===================================================
+   Feeds TraceRecords into any Mmu<...> instantiation (mmu.h) through a
+   driver: DetailedReplay below, or SampledReplay (sampling.h). Both
+   are template parameters, so each combination gets its own inlined
+   loop. Records come from a trace file or straight from the workload
+   generator (no text round trip).                                     */
+
+// Bulk ops (S/L/M) move through this buffer in 64 KiB pieces; the MMU
+// still translates once per page.
+const u64 REPLAY_CHUNK = 64 * 1024;
+
+template <class M>
+void Replay_Bulk(M& mmu, const TraceRecord& rec) {
+    static unsigned char scratch[REPLAY_CHUNK];
+    if (rec.op == 'S') std::memset(scratch, (unsigned char)rec.data, sizeof(scratch));
+    for (u64 done = 0; done < rec.len;) {
+        u64 n = rec.len - done < REPLAY_CHUNK ? rec.len - done : REPLAY_CHUNK;
+        u64 moved;
+        switch (rec.op) {
+            case 'S': moved = mmu.write(rec.pid, rec.va + done, scratch, n); break;
+            case 'L': moved = mmu.read(rec.pid, rec.va + done, scratch, n); break;
+            default:  // 'M': source first, then destination
+                moved = mmu.read(rec.pid, rec.src + done, scratch, n);
+                if (moved == n) moved = mmu.write(rec.pid, rec.va + done, scratch, n);
+                break;
+        }
+        if (moved < n) return; // Segmentation fault: the rest is not copied
+        done += n;
+    }
+}
+
+template <class M>
+inline void Replay_Record(M& mmu, const TraceRecord& rec, IntervalStats* stats) {
+    switch (rec.op) {
+        case 'C': mmu.context_switch(rec.pid); return;
+        case 'F': mmu.fork(rec.pid, rec.child); return;
+        case 'R': { unsigned char v; mmu.load(rec.pid, rec.va, &v); break; }
+        case 'W': mmu.store(rec.pid, rec.va, (unsigned char)rec.data); break;
+        case 'S':
+        case 'L':
+        case 'M': Replay_Bulk(mmu, rec); break;
+        default:  return; // 'V' and unknown ops do not touch memory
+    }
+    mmu.tick();
+    if (stats != nullptr && stats->due()) stats->snapshot(mmu.counters());
+}
+
+// The plain driver: every record through the detailed model.
+// Other drivers (sampling.h) expose the same apply() and plug in below.
+template <class M>
+struct DetailedReplay {
+    M& mmu;
+    explicit DetailedReplay(M& m) : mmu(m) {}
+    inline void apply(const TraceRecord& rec, IntervalStats* stats) { Replay_Record(mmu, rec, stats); }
+};
+
+// Returns the number of records applied (at most `limit`)
+template <class Driver>
+u64 Replay_Trace_File(Driver& driver, TraceFileReader& in, IntervalStats* stats = nullptr, u64 limit = ~0ULL) {
+    TraceRecord rec;
+    u64 n = 0;
+    while (n < limit && in.next(rec)) {
+        driver.apply(rec, stats);
+        n++;
+    }
+    return n;
+}
+
+template <class Driver>
+u64 Replay_Generator(Driver& driver, WorkloadGenerator& gen, u64 count, IntervalStats* stats = nullptr) {
+    gen.run(count, [&](const TraceRecord& rec) { driver.apply(rec, stats); });
+    return count;
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include "mmu.h"
+#include "replay.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Sampled Simulation
+   ===================================================
+   The access stream is cut into periods of `period` accesses. Each
+   period ends with
+       [ warmup: detailed, not measured ][ window: detailed, measured ]
+   and everything before that runs in the MMU's functional mode
+   (mappings, faults and frame recency; no TLB model).
+
+   Faults and evictions never depend on the TLB, so the functional
+   model keeps them exact over the whole run. TLB misses, walks and
+   the modelled translation cost are measured only inside windows and
+   extrapolated: mean per-access rate over windows x total accesses,
+   with a 95% Student-t confidence interval across windows.           */
+
+struct SamplingConfig {
+    u64 period = 1000000; // Accesses per sampling unit
+    u64 warmup = 20000;   // Detailed, unmeasured: refills the TLB
+    u64 window = 10000;   // Detailed, measured
+};
+
+// Modelled cost of each translation outcome, in ns
+struct CostModel {
+    double tlb_hit = 1.0;
+    double walk = 20.0;
+    double minor_fault = 500.0;
+    double major_fault = 5000.0;
+
+    double total(const MmuStats& d) const {
+        u64 minor = d.faults - d.major_faults;
+        return d.tlb_hits * tlb_hit + d.walk_hits * walk + minor * minor_fault + d.major_faults * major_fault;
+    }
+};
+
+// Two-sided 95% quantile of Student's t with `df` degrees of freedom
+inline double Student_T95(u64 df) {
+    static const double table[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                     2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                     2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                     2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0) return 0.0;
+    if (df <= 30) return table[df - 1];
+    return 1.96 + 2.4 / (double)df;
+}
+
+// Mean of per-window samples with its 95% confidence half-width
+struct Estimate {
+    double mean = 0;
+    double half_width = 0;
+};
+
+inline Estimate Estimate_Mean(const std::vector<double>& xs) {
+    Estimate e;
+    if (xs.empty()) return e;
+    double sum = 0;
+    for (double x : xs) sum += x;
+    e.mean = sum / xs.size();
+    if (xs.size() < 2) return e;
+    double ss = 0;
+    for (double x : xs) ss += (x - e.mean) * (x - e.mean);
+    double sd = std::sqrt(ss / (xs.size() - 1));
+    e.half_width = Student_T95(xs.size() - 1) * sd / std::sqrt((double)xs.size());
+    return e;
+}
+
+template <class M>
+class SampledReplay {
+public:
+    SampledReplay(M& m, const SamplingConfig& c, const CostModel& cost_model)
+        : mmu(m), cfg(c), cost(cost_model) {
+        if (cfg.period == 0) cfg.period = 1;
+        if (cfg.window > cfg.period) cfg.window = cfg.period;
+        if (cfg.warmup > cfg.period - cfg.window) cfg.warmup = cfg.period - cfg.window;
+        measure_at = cfg.period - cfg.window;
+        detail_at = measure_at - cfg.warmup;
+    }
+
+    inline void apply(const TraceRecord& rec, IntervalStats* stats) {
+        bool access = rec.op == 'R' || rec.op == 'W' || is_bulk_op(rec.op);
+        if (access) {
+            if (pos == 0) mmu.set_functional(detail_at > 0);
+            if (pos == detail_at) mmu.set_functional(false);
+            if (pos == measure_at) start = mmu.stats;
+        }
+        Replay_Record(mmu, rec, stats);
+        if (!access) return;
+
+        if (++pos == cfg.period) {
+            close_window();
+            pos = 0;
+        }
+    }
+
+    // Partial window at the end of the stream counts if it was measured
+    void finish() {
+        if (pos > measure_at) close_window();
+        pos = 0;
+        mmu.set_functional(false);
+    }
+
+    void print(FILE* out = stdout) const {
+        const MmuStats& s = mmu.stats;
+        double total = (double)s.accesses;
+        Estimate miss = Estimate_Mean(tlb_miss_rate);
+        Estimate walk = Estimate_Mean(walk_rate);
+        Estimate ns = Estimate_Mean(cost_per_access);
+
+        fprintf(out, "\n=== SAMPLED ESTIMATE (period=%llu, warmup=%llu, window=%llu) ===\n",
+                (unsigned long long)cfg.period, (unsigned long long)cfg.warmup, (unsigned long long)cfg.window);
+        fprintf(out, "Windows:           %zu (%.2f%% of accesses detailed, %.2f%% measured)\n",
+                tlb_miss_rate.size(), total > 0 ? 100.0 * (s.accesses - s.functional) / total : 0.0,
+                total > 0 ? 100.0 * measured / total : 0.0);
+        fprintf(out, "Page Faults:       %llu (exact)\n", (unsigned long long)s.faults);
+        fprintf(out, "Evictions:         %llu (exact)\n", (unsigned long long)s.evictions);
+        fprintf(out, "%-18s %14s %12s %16s %14s\n", "", "per access", "95% CI +/-", "total", "+/-");
+        print_row(out, "TLB Misses:", miss, total);
+        print_row(out, "Walk Hits:", walk, total);
+        print_row(out, "Modelled ns:", ns, total);
+    }
+
+    const std::vector<double>& tlb_miss_samples() const { return tlb_miss_rate; }
+
+private:
+    M& mmu;
+    SamplingConfig cfg;
+    CostModel cost;
+    u64 pos = 0;
+    u64 detail_at = 0;
+    u64 measure_at = 0;
+    u64 measured = 0;
+    MmuStats start;
+    std::vector<double> tlb_miss_rate, walk_rate, cost_per_access;
+
+    void close_window() {
+        if (cfg.window == 0) return;
+        const MmuStats& now = mmu.stats;
+        MmuStats d;
+        d.accesses = now.accesses - start.accesses;
+        if (d.accesses == 0) return;
+        d.tlb_hits = now.tlb_hits - start.tlb_hits;
+        d.tlb_misses = now.tlb_misses - start.tlb_misses;
+        d.walk_hits = now.walk_hits - start.walk_hits;
+        d.faults = now.faults - start.faults;
+        d.major_faults = now.major_faults - start.major_faults;
+        d.evictions = now.evictions - start.evictions;
+        measured += d.accesses;
+        tlb_miss_rate.push_back((double)d.tlb_misses / d.accesses);
+        walk_rate.push_back((double)d.walk_hits / d.accesses);
+        cost_per_access.push_back(cost.total(d) / d.accesses);
+    }
+
+    static void print_row(FILE* out, const char* name, const Estimate& e, double total) {
+        fprintf(out, "%-18s %14.6f %12.6f %16.0f %14.0f\n", name, e.mean, e.half_width,
+                e.mean * total, e.half_width * total);
+    }
+};
+
+#endif
@@ -0,0 +1,1218 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "mglru.h"
+#include "mmu.h"
+#include "replacement.h"
+#include "workload.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Snapshot / Restore
+   ===================================================
+   One file holds the full state of an Mmu<...>: page tables, frame
+   table with recency order, TLB, prefetcher, KSM scanner, zswap pool,
+   tier daemon, cache hierarchy, counters and the trace position.
+
+   Layout (little-endian, no pointers anywhere):
+     SnapshotHeader                checksum of everything after it
+     SnapshotSection[sections]     tag, offset, bytes
+     section payloads              each 64-byte aligned; every field
+                                   inside is padded to 8 bytes
+
+   Tree nodes refer to their children by index into the node array of
+   the same section, so the file is position independent. Restore maps
+   it read-only and rebuilds the live structures with bulk copies plus
+   one index -> pointer fix-up pass over the radix nodes.              */
+
+const char SNAPSHOT_MAGIC[8] = {'P', 'G', 'S', 'N', 'A', 'P', '0', '1'};
+// Bump on every change to the bytes on disk; the loader only accepts
+// its own version. History:
+//   1  initial format, then grown in place by the prefetch, adaptive
+//      and clustered tables, COW (FrameInfo refs), KSM, zswap, tiers
+//      (FRAMES nodes) and ARC/2Q/LIRS sections; those files cannot be
+//      told apart and are rejected like any other old version
+//   2  MGLRU generations and accessed bits
+//   3  coalesced TLB runs
+//   4  CACHE section
+//   5  MmuStats::major_faults
+//   6  header checksum
+//   7  MGLRU aging interval
+const uint32_t SNAPSHOT_VERSION = 7;
+const uint32_t SNAP_NIL = 0xFFFFFFFFu;
+
+enum SnapshotTag {
+    SNAP_CONFIG = 1,
+    SNAP_TRACE,
+    SNAP_STATS,
+    SNAP_FRAMES,
+    SNAP_POLICY,
+    SNAP_TLB,
+    SNAP_TABLES,
+    SNAP_RAM,
+    SNAP_PREFETCH,
+    SNAP_KSM,
+    SNAP_ZSWAP,
+    SNAP_TIERS,
+    SNAP_CACHE
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sections;
+    u64 file_bytes;
+    u64 checksum; // Snapshot_Checksum of the bytes after the header
+};
+
+// Word-wise multiply-xor hash; `bytes` is a multiple of 8
+inline u64 Snapshot_Checksum(u64 h, const void* p, u64 bytes) {
+    const char* c = (const char*)p;
+    for (u64 i = 0; i < bytes; i += 8) {
+        u64 w;
+        std::memcpy(&w, c + i, 8);
+        h = (h ^ w) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+const u64 SNAPSHOT_CHECKSUM_SEED = 0xCBF29CE484222325ULL;
+
+struct SnapshotSection {
+    uint32_t tag;
+    uint32_t reserved;
+    u64 offset;
+    u64 bytes;
+};
+
+// What the run was configured with: enough to rebuild the same Mmu<>
+struct SnapshotConfig {
+    char backend[16] = {};
+    char policy[16] = {};
+    u64 frames = 0;
+    u64 virtual_pages = 0;
+    u64 tlb_entries = 0;   // 0 = NoTLB
+    uint32_t tlb_mode = 0;
+    uint32_t asids = 1;
+    u64 tlb_window = 0;
+    uint32_t data = 0;     // Frame contents included
+    uint32_t reserved = 0;
+};
+
+// Where the replay stopped
+struct SnapshotTrace {
+    u64 records = 0;       // Records consumed, switch records included
+    u64 file_offset = 0;   // Byte offset in the trace file (file runs)
+    uint32_t generated = 0; // 1 = records came from the workload generator
+    uint32_t reserved = 0;
+    WorkloadSpec spec;     // Generator settings (generated runs)
+};
+
+/* ---------------------------------------------------
+   Writer: sections are built in memory, then written once */
+struct SnapshotBlob {
+    uint32_t tag;
+    std::vector<char> bytes;
+
+    void put_bytes(const void* p, size_t n) {
+        const char* c = (const char*)p;
+        bytes.insert(bytes.end(), c, c + n);
+        bytes.resize((bytes.size() + 7) & ~(size_t)7, 0);
+    }
+    template <class T> void put(const T& v) { put_bytes(&v, sizeof(T)); }
+    template <class T> void put_array(const T* p, size_t n) { put_bytes(p, n * sizeof(T)); }
+};
+
+struct SnapshotWriter {
+    std::deque<SnapshotBlob> blobs;
+
+    SnapshotBlob& section(uint32_t tag) {
+        blobs.push_back(SnapshotBlob());
+        blobs.back().tag = tag;
+        return blobs.back();
+    }
+
+    bool write(const std::string& path) const {
+        std::vector<SnapshotSection> dir(blobs.size());
+        u64 offset = sizeof(SnapshotHeader) + dir.size() * sizeof(SnapshotSection);
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            offset = (offset + 63) & ~(u64)63;
+            dir[i].tag = blobs[i].tag;
+            dir[i].reserved = 0;
+            dir[i].offset = offset;
+            dir[i].bytes = blobs[i].bytes.size();
+            offset += dir[i].bytes;
+        }
+
+        SnapshotHeader h;
+        std::memcpy(h.magic, SNAPSHOT_MAGIC, 8);
+        h.version = SNAPSHOT_VERSION;
+        h.sections = (uint32_t)dir.size();
+        h.file_bytes = offset;
+        static const char zeros[64] = {};
+        h.checksum = Snapshot_Checksum(SNAPSHOT_CHECKSUM_SEED, dir.data(), dir.size() * sizeof(SnapshotSection));
+        u64 at = sizeof(SnapshotHeader) + dir.size() * sizeof(SnapshotSection);
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            h.checksum = Snapshot_Checksum(h.checksum, zeros, dir[i].offset - at);
+            h.checksum = Snapshot_Checksum(h.checksum, blobs[i].bytes.data(), blobs[i].bytes.size());
+            at = dir[i].offset + blobs[i].bytes.size();
+        }
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+        if (!dir.empty()) ok = ok && std::fwrite(dir.data(), sizeof(SnapshotSection), dir.size(), f) == dir.size();
+        at = sizeof(SnapshotHeader) + dir.size() * sizeof(SnapshotSection);
+        for (size_t i = 0; i < blobs.size() && ok; ++i) {
+            ok = std::fwrite(zeros, 1, dir[i].offset - at, f) == dir[i].offset - at;
+            const std::vector<char>& b = blobs[i].bytes;
+            if (!b.empty()) ok = ok && std::fwrite(b.data(), 1, b.size(), f) == b.size();
+            at = dir[i].offset + b.size();
+        }
+        return (std::fclose(f) == 0) && ok;
+    }
+};
+
+/* ---------------------------------------------------
+   Reader: the file is mmap'd; cursors hand out pointers into it */
+struct SnapshotCursor {
+    const char* p = nullptr;
+    const char* end = nullptr;
+
+    const void* take(size_t n) {
+        size_t padded = (n + 7) & ~(size_t)7;
+        if ((size_t)(end - p) < padded) return nullptr;
+        const void* at = p;
+        p += padded;
+        return at;
+    }
+    template <class T> bool get(T& out) {
+        const void* at = take(sizeof(T));
+        if (at == nullptr) return false;
+        std::memcpy(&out, at, sizeof(T));
+        return true;
+    }
+    template <class T> const T* get_array(size_t n) { return (const T*)take(n * sizeof(T)); }
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader() {}
+    ~SnapshotReader() { if (base != nullptr) munmap(base, size); }
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) { ::close(fd); return false; }
+        size = (size_t)st.st_size;
+        void* m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) return false;
+        base = m;
+
+        const SnapshotHeader* h = (const SnapshotHeader*)base;
+        if (std::memcmp(h->magic, SNAPSHOT_MAGIC, 8) != 0 || h->version != SNAPSHOT_VERSION ||
+            h->file_bytes != size || (size - sizeof(SnapshotHeader)) % 8 != 0 ||
+            sizeof(SnapshotHeader) + (u64)h->sections * sizeof(SnapshotSection) > size ||
+            Snapshot_Checksum(SNAPSHOT_CHECKSUM_SEED, (const char*)base + sizeof(SnapshotHeader),
+                              size - sizeof(SnapshotHeader)) != h->checksum) {
+            return false;
+        }
+        dir = (const SnapshotSection*)((const char*)base + sizeof(SnapshotHeader));
+        sections = h->sections;
+        for (uint32_t i = 0; i < sections; ++i) {
+            if (dir[i].offset > size || dir[i].bytes > size - dir[i].offset) return false;
+        }
+        return true;
+    }
+
+    bool find(uint32_t tag, SnapshotCursor* out) const {
+        for (uint32_t i = 0; i < sections; ++i) {
+            if (dir[i].tag != tag) continue;
+            out->p = (const char*)base + dir[i].offset;
+            out->end = out->p + dir[i].bytes;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    void* base = nullptr;
+    size_t size = 0;
+    const SnapshotSection* dir = nullptr;
+    uint32_t sections = 0;
+};
+
+/* ===================================================
+   Per-Component Save / Load
+   =================================================== */
+
+// --- Linear: per process, the PTE array as is ---
+inline void Snapshot_Save_Table(SnapshotBlob& b, const LinearBackend& t) {
+    b.put((u64)t.procs.by_pid.size());
+    for (auto& p : t.procs.by_pid) {
+        b.put(p.first);
+        b.put(p.second->live_entries);
+        b.put((u64)p.second->entries.size());
+        b.put_array(p.second->entries.data(), p.second->entries.size());
+    }
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, LinearBackend& t) {
+    u64 procs;
+    if (!c.get(procs)) return false;
+    for (u64 i = 0; i < procs; ++i) {
+        u64 pid, live, n;
+        if (!c.get(pid) || !c.get(live) || !c.get(n)) return false;
+        const LinearPTE* src = c.get_array<LinearPTE>(n);
+        if (src == nullptr) return false;
+        LinearPageTable* table = new LinearPageTable(n);
+        std::memcpy((void*)table->entries.data(), src, n * sizeof(LinearPTE));
+        table->live_entries = live;
+        t.procs.by_pid[pid] = table;
+    }
+    return true;
+}
+
+// --- Two-level: directory as table indices, then the PageTables ---
+inline void Snapshot_Save_Table(SnapshotBlob& b, const TwoLevelBackend& t) {
+    b.put((u64)t.procs.by_pid.size());
+    for (auto& p : t.procs.by_pid) {
+        uint32_t index[1024];
+        std::vector<PageTable> tables;
+        for (int i = 0; i < 1024; ++i) {
+            index[i] = p.second->tables[i] ? (uint32_t)tables.size() : SNAP_NIL;
+            if (p.second->tables[i]) tables.push_back(*p.second->tables[i]);
+        }
+        b.put(p.first);
+        b.put((u64)tables.size());
+        b.put_array(index, 1024);
+        b.put_array(tables.data(), tables.size());
+    }
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, TwoLevelBackend& t) {
+    u64 procs;
+    if (!c.get(procs)) return false;
+    for (u64 i = 0; i < procs; ++i) {
+        u64 pid, n;
+        if (!c.get(pid) || !c.get(n)) return false;
+        const uint32_t* index = c.get_array<uint32_t>(1024);
+        const PageTable* tables = c.get_array<PageTable>(n);
+        if (index == nullptr || tables == nullptr) return false;
+        PageDirectory* dir = new PageDirectory();
+        for (int d = 0; d < 1024; ++d) {
+            if (index[d] == SNAP_NIL) continue;
+            if (index[d] >= n) { delete dir; return false; }
+            dir->tables[d] = new PageTable(tables[index[d]]);
+        }
+        t.procs.by_pid[pid] = dir;
+        t.tables_live += n;
+    }
+    return true;
+}
+
+// --- Four-level: nodes in preorder; branch slots hold child indices ---
+struct SnapNodeV2 {
+    u64 slot[ENTRIES_PER_TABLE];  // Child node index (branch) or frame (leaf)
+    u64 valid[ENTRIES_PER_TABLE / 64];
+    u64 accessed[ENTRIES_PER_TABLE / 64]; // Leaf PTE accessed bits
+    int32_t level;
+    int32_t live_entries;
+};
+
+inline void Snapshot_Flatten_V2(const PageTableV2* table, int level, std::vector<SnapNodeV2>& out) {
+    size_t me = out.size();
+    out.push_back(SnapNodeV2());
+    std::memset(&out[me], 0, sizeof(SnapNodeV2));
+    out[me].level = level;
+    out[me].live_entries = table->live_entries;
+    for (int i = 0; i < ENTRIES_PER_TABLE; ++i) {
+        const PageTableEntryV2& e = table->entries[i];
+        if (!e.is_valid) continue;
+        out[me].valid[i / 64] |= 1ULL << (i % 64);
+        out[me].accessed[i / 64] |= (u64)e.accessed << (i % 64);
+        if (level < LEVELS - 1) {
+            u64 child = out.size();
+            Snapshot_Flatten_V2(e.next_level_page_table, level + 1, out);
+            out[me].slot[i] = child;
+        } else {
+            out[me].slot[i] = e.frame_number;
+        }
+    }
+}
+
+inline void Snapshot_Save_Table(SnapshotBlob& b, const FourLevelBackend& t) {
+    b.put((u64)t.procs.by_pid.size());
+    std::vector<SnapNodeV2> nodes;
+    for (auto& p : t.procs.by_pid) {
+        nodes.clear();
+        Snapshot_Flatten_V2(p.second->root, 0, nodes);
+        b.put(p.first);
+        b.put(p.second->nodes_allocated);
+        b.put(p.second->nodes_reclaimed);
+        b.put((u64)nodes.size());
+        b.put_array(nodes.data(), nodes.size());
+    }
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, FourLevelBackend& t) {
+    u64 procs;
+    if (!c.get(procs)) return false;
+    for (u64 i = 0; i < procs; ++i) {
+        u64 pid, allocated, reclaimed, n;
+        if (!c.get(pid) || !c.get(allocated) || !c.get(reclaimed) || !c.get(n)) return false;
+        const SnapNodeV2* src = c.get_array<SnapNodeV2>(n);
+        if (src == nullptr || n == 0) return false;
+
+        // Reject child indices that point outside this tree before allocating
+        for (u64 k = 0; k < n; ++k) {
+            if (src[k].level >= LEVELS - 1) continue;
+            for (int e = 0; e < ENTRIES_PER_TABLE; ++e) {
+                if ((src[k].valid[e / 64] >> (e % 64) & 1) && src[k].slot[e] >= n) return false;
+            }
+        }
+
+        // Pass 1: allocate every node; pass 2: fill entries, index -> pointer
+        std::vector<PageTableV2*> nodes(n);
+        for (u64 k = 0; k < n; ++k) nodes[k] = new PageTableV2();
+        for (u64 k = 0; k < n; ++k) {
+            PageTableV2* node = nodes[k];
+            node->live_entries = src[k].live_entries;
+            for (int e = 0; e < ENTRIES_PER_TABLE; ++e) {
+                if (!(src[k].valid[e / 64] >> (e % 64) & 1)) continue;
+                node->entries[e].is_valid = true;
+                node->entries[e].accessed = src[k].accessed[e / 64] >> (e % 64) & 1;
+                if (src[k].level < LEVELS - 1) {
+                    node->entries[e].next_level_page_table = nodes[src[k].slot[e]];
+                } else {
+                    node->entries[e].frame_number = src[k].slot[e];
+                }
+            }
+        }
+        PageTreeV2* tree = new PageTreeV2();
+        delete tree->root;
+        tree->root = nodes[0];
+        tree->nodes_live = n;
+        tree->nodes_allocated = allocated;
+        tree->nodes_reclaimed = reclaimed;
+        t.procs.by_pid[pid] = tree;
+    }
+    return true;
+}
+
+// --- Adaptive: nodes in preorder, each followed by its (key, slot) pairs ---
+struct SnapArtNode {
+    uint32_t type;
+    uint32_t level;
+    u64 count;
+};
+
+struct SnapArtEntry {
+    u64 key;
+    u64 slot; // Child node index (branch) or frame (leaf)
+};
+
+inline void Snapshot_Flatten_Art(const ArtNode* n, std::vector<SnapArtNode>& nodes,
+                                 std::vector<SnapArtEntry>& entries) {
+    nodes.push_back({n->type, n->level, n->count});
+    size_t first = entries.size();
+    bool leaf = n->level == ART_LEVELS - 1;
+    Art_For_Each(n, [&](unsigned key, ArtSlot s) { entries.push_back({key, leaf ? s.frame : (u64)(uintptr_t)s.child}); });
+    if (leaf) return;
+    for (size_t e = first; e < first + n->count; ++e) {
+        const ArtNode* child = (const ArtNode*)entries[e].slot;
+        entries[e].slot = nodes.size();
+        Snapshot_Flatten_Art(child, nodes, entries);
+    }
+}
+
+inline void Snapshot_Save_Table(SnapshotBlob& b, const AdaptiveBackend& t) {
+    b.put((u64)t.procs.by_pid.size());
+    std::vector<SnapArtNode> nodes;
+    std::vector<SnapArtEntry> entries;
+    for (auto& p : t.procs.by_pid) {
+        nodes.clear();
+        entries.clear();
+        if (p.second->root) Snapshot_Flatten_Art(p.second->root, nodes, entries);
+        b.put(p.first);
+        b.put(p.second->grows);
+        b.put(p.second->shrinks);
+        b.put((u64)nodes.size());
+        b.put((u64)entries.size());
+        b.put_array(nodes.data(), nodes.size());
+        b.put_array(entries.data(), entries.size());
+    }
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, AdaptiveBackend& t) {
+    u64 procs;
+    if (!c.get(procs)) return false;
+    for (u64 i = 0; i < procs; ++i) {
+        u64 pid, grows, shrinks, n, m;
+        if (!c.get(pid) || !c.get(grows) || !c.get(shrinks) || !c.get(n) || !c.get(m)) return false;
+        const SnapArtNode* src = c.get_array<SnapArtNode>(n);
+        const SnapArtEntry* ent = c.get_array<SnapArtEntry>(m);
+        if (src == nullptr || ent == nullptr) return false;
+
+        // Validate before allocating: types, counts, unique keys, and every
+        // child index referring to a later node of the next level exactly once
+        std::vector<char> referenced(n, 0);
+        u64 total = 0;
+        for (u64 k = 0; k < n; ++k) {
+            if (src[k].type > ART_NODE512 || src[k].level >= (uint32_t)ART_LEVELS) return false;
+            if (src[k].count > (u64)ART_CAPACITY[src[k].type] || total + src[k].count > m) return false;
+            u64 seen[ART_FANOUT / 64] = {};
+            for (u64 e = total; e < total + src[k].count; ++e) {
+                if (ent[e].key >= (u64)ART_FANOUT || (seen[ent[e].key >> 6] >> (ent[e].key & 63) & 1)) return false;
+                seen[ent[e].key >> 6] |= 1ULL << (ent[e].key & 63);
+                if (src[k].level == ART_LEVELS - 1) continue;
+                u64 child = ent[e].slot;
+                if (child <= k || child >= n || referenced[child] || src[child].level != src[k].level + 1) return false;
+                referenced[child] = 1;
+            }
+            total += src[k].count;
+        }
+        if (total != m || (n > 0 && src[0].level != 0)) return false;
+
+        AdaptiveTree* tree = new AdaptiveTree();
+        std::vector<ArtNode*> built(n);
+        for (u64 k = 0; k < n; ++k) built[k] = Art_New(tree, src[k].type, src[k].level);
+        total = 0;
+        for (u64 k = 0; k < n; ++k) {
+            for (u64 e = total; e < total + src[k].count; ++e) {
+                ArtSlot s;
+                if (src[k].level < ART_LEVELS - 1) s.child = built[ent[e].slot];
+                else s.frame = ent[e].slot;
+                Art_Insert_Raw(built[k], (unsigned)ent[e].key, s);
+            }
+            total += src[k].count;
+        }
+        tree->root = n > 0 ? built[0] : nullptr;
+        tree->grows = grows;
+        tree->shrinks = shrinks;
+        t.procs.by_pid[pid] = tree;
+    }
+    return true;
+}
+
+// --- Inverted: (PID, VPN, PFN) triples bucket by bucket, chain order ---
+struct SnapIptEntry {
+    u64 pid, vpn, pfn;
+};
+
+inline void Snapshot_Save_Table(SnapshotBlob& b, const InvertedBackend& t) {
+    std::vector<SnapIptEntry> all;
+    all.reserve(t.ipt.num_nodes);
+    for (Node* head : t.ipt.buckets) {
+        for (Node* n = head; n != nullptr; n = n->next) all.push_back({n->PID, n->VPN, n->PFN});
+    }
+    b.put((u64)t.ipt.buckets.size());
+    b.put((u64)all.size());
+    b.put_array(all.data(), all.size());
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, InvertedBackend& t) {
+    u64 buckets, n;
+    if (!c.get(buckets) || !c.get(n) || buckets != t.ipt.buckets.size()) return false;
+    const SnapIptEntry* src = c.get_array<SnapIptEntry>(n);
+    if (src == nullptr) return false;
+    // Head insertion in reverse rebuilds every chain in its saved order
+    for (u64 k = n; k > 0; --k) {
+        const SnapIptEntry& e = src[k - 1];
+        u64 idx = Hash_Function(&t.ipt, e.pid, e.vpn);
+        t.ipt.buckets[idx] = new Node{e.pid, e.vpn, e.pfn, t.ipt.buckets[idx]};
+    }
+    t.ipt.num_nodes = n;
+    return true;
+}
+
+// --- Clustered: the bucket array is pointer-free; copied whole ---
+inline void Snapshot_Save_Table(SnapshotBlob& b, const ClusteredBackend& t) {
+    b.put((u64)t.cpt.buckets.size());
+    b.put_array(t.cpt.buckets.data(), t.cpt.buckets.size());
+}
+
+inline bool Snapshot_Load_Table(SnapshotCursor& c, ClusteredBackend& t) {
+    u64 n;
+    if (!c.get(n) || n == 0 || (n & (n - 1))) return false;
+    const PteCluster* src = c.get_array<PteCluster>(n);
+    if (src == nullptr) return false;
+    t.cpt.buckets.assign(src, src + n);
+    t.cpt.mask = n - 1;
+    t.cpt.num_clusters = t.cpt.num_pages = 0;
+    for (const PteCluster& cl : t.cpt.buckets) {
+        if (cl.valid == 0) continue;
+        t.cpt.num_clusters++;
+        t.cpt.num_pages += __builtin_popcount(cl.valid);
+    }
+    return t.cpt.num_clusters * 2 <= n;
+}
+
+// A bool copied from the file must hold 0 or 1 (read as a byte)
+inline bool Snapshot_Check_Bool(const bool* b) {
+    unsigned char byte;
+    std::memcpy(&byte, b, 1);
+    return byte <= 1;
+}
+
+// Intrusive index lists (every policy's NIL is SNAP_NIL): every link in
+// range, and the list from head runs back-linked to tail without a
+// cycle. `length` (if given) must match.
+inline bool Snapshot_Check_Links(const std::vector<uint32_t>& prev, const std::vector<uint32_t>& next) {
+    for (std::size_t i = 0; i < prev.size(); ++i) {
+        if ((prev[i] != SNAP_NIL && prev[i] >= prev.size()) || (next[i] != SNAP_NIL && next[i] >= next.size())) {
+            return false;
+        }
+    }
+    return prev.size() == next.size();
+}
+
+inline bool Snapshot_Check_List(uint32_t head, uint32_t tail, const std::vector<uint32_t>& prev,
+                                const std::vector<uint32_t>& next, const u64* length = nullptr) {
+    const u64 n = prev.size();
+    if ((head == SNAP_NIL) != (tail == SNAP_NIL) || (head != SNAP_NIL && (head >= n || tail >= n))) return false;
+    u64 count = 0;
+    uint32_t last = SNAP_NIL;
+    for (uint32_t i = head; i != SNAP_NIL; last = i, i = next[i]) {
+        if (++count > n || prev[i] != last) return false;
+    }
+    return last == tail && (length == nullptr || *length == count);
+}
+
+// --- LRU policy: the intrusive list is already index based ---
+inline void Snapshot_Save_Policy(SnapshotBlob& b, const LruPolicy& p) {
+    b.put(p.head);
+    b.put(p.tail);
+    b.put_array(p.prev.data(), p.prev.size());
+    b.put_array(p.next.data(), p.next.size());
+}
+
+inline bool Snapshot_Load_Policy(SnapshotCursor& c, LruPolicy& p) {
+    const uint32_t* prev;
+    const uint32_t* next;
+    if (!c.get(p.head) || !c.get(p.tail)) return false;
+    if (!(prev = c.get_array<uint32_t>(p.prev.size())) || !(next = c.get_array<uint32_t>(p.next.size()))) return false;
+    p.prev.assign(prev, prev + p.prev.size());
+    p.next.assign(next, next + p.next.size());
+    return Snapshot_Check_Links(p.prev, p.next) && Snapshot_Check_List(p.head, p.tail, p.prev, p.next);
+}
+
+// --- ARC / 2Q / LIRS: lists and ghost slots are index based too ---
+inline void Snapshot_Save_List(SnapshotBlob& b, const PolicyList& l) {
+    b.put(l.head);
+    b.put(l.tail);
+    b.put(l.size);
+    b.put_array(l.prev.data(), l.prev.size());
+    b.put_array(l.next.data(), l.next.size());
+}
+
+inline bool Snapshot_Load_List(SnapshotCursor& c, PolicyList& l) {
+    const uint32_t* prev;
+    const uint32_t* next;
+    if (!c.get(l.head) || !c.get(l.tail) || !c.get(l.size) || l.size > l.prev.size()) return false;
+    if (!(prev = c.get_array<uint32_t>(l.prev.size())) || !(next = c.get_array<uint32_t>(l.next.size()))) return false;
+    l.prev.assign(prev, prev + l.prev.size());
+    l.next.assign(next, next + l.next.size());
+    return Snapshot_Check_Links(l.prev, l.next) && Snapshot_Check_List(l.head, l.tail, l.prev, l.next, &l.size);
+}
+
+// Per-frame (or per-slot) array of the size init() gave it
+template <class T>
+void Snapshot_Save_Vector(SnapshotBlob& b, const std::vector<T>& v) { b.put_array(v.data(), v.size()); }
+
+template <class T>
+bool Snapshot_Load_Vector(SnapshotCursor& c, std::vector<T>& v) {
+    const T* src = c.get_array<T>(v.size());
+    if (src == nullptr) return false;
+    v.assign(src, src + v.size());
+    return true;
+}
+
+inline void Snapshot_Save_Ghosts(SnapshotBlob& b, const GhostList& g) {
+    Snapshot_Save_List(b, g.order);
+    Snapshot_Save_Vector(b, g.keys);
+}
+
+// The key index and free slots follow from the order list
+inline bool Snapshot_Load_Ghosts(SnapshotCursor& c, GhostList& g) {
+    if (!Snapshot_Load_List(c, g.order) || !Snapshot_Load_Vector(c, g.keys)) return false;
+    std::vector<uint8_t> used(g.capacity(), 0);
+    g.index.clear();
+    u64 n = 0;
+    for (uint32_t s = g.order.head; s != PolicyList::NIL; s = g.order.next[s]) {
+        if (s >= g.capacity() || used[s] || ++n > g.order.size) return false;
+        used[s] = 1;
+        g.index[g.keys[s]] = s;
+    }
+    if (n != g.order.size) return false;
+    g.free_slots.clear();
+    for (u64 s = g.capacity(); s > 0; --s) {
+        if (!used[s - 1]) g.free_slots.push_back((uint32_t)(s - 1));
+    }
+    return true;
+}
+
+inline void Snapshot_Save_Policy(SnapshotBlob& b, const ArcPolicy& p) {
+    b.put(p.p);
+    Snapshot_Save_List(b, p.t1);
+    Snapshot_Save_List(b, p.t2);
+    Snapshot_Save_Ghosts(b, p.b1);
+    Snapshot_Save_Ghosts(b, p.b2);
+    Snapshot_Save_Vector(b, p.where);
+    Snapshot_Save_Vector(b, p.page);
+}
+
+inline bool Snapshot_Load_Policy(SnapshotCursor& c, ArcPolicy& p) {
+    return c.get(p.p) && p.p <= p.c && Snapshot_Load_List(c, p.t1) && Snapshot_Load_List(c, p.t2) &&
+           Snapshot_Load_Ghosts(c, p.b1) && Snapshot_Load_Ghosts(c, p.b2) && Snapshot_Load_Vector(c, p.where) &&
+           Snapshot_Load_Vector(c, p.page);
+}
+
+inline void Snapshot_Save_Policy(SnapshotBlob& b, const TwoQPolicy& p) {
+    Snapshot_Save_List(b, p.a1in);
+    Snapshot_Save_List(b, p.am);
+    Snapshot_Save_Ghosts(b, p.a1out);
+    Snapshot_Save_Vector(b, p.where);
+    Snapshot_Save_Vector(b, p.page);
+}
+
+inline bool Snapshot_Load_Policy(SnapshotCursor& c, TwoQPolicy& p) {
+    return Snapshot_Load_List(c, p.a1in) && Snapshot_Load_List(c, p.am) && Snapshot_Load_Ghosts(c, p.a1out) &&
+           Snapshot_Load_Vector(c, p.where) && Snapshot_Load_Vector(c, p.page);
+}
+
+inline void Snapshot_Save_Policy(SnapshotBlob& b, const LirsPolicy& p) {
+    b.put(p.lir);
+    Snapshot_Save_List(b, p.s);
+    Snapshot_Save_List(b, p.q);
+    Snapshot_Save_Ghosts(b, p.ghosts);
+    Snapshot_Save_Vector(b, p.status);
+    Snapshot_Save_Vector(b, p.in_s);
+    Snapshot_Save_Vector(b, p.page);
+}
+
+inline bool Snapshot_Load_Policy(SnapshotCursor& c, LirsPolicy& p) {
+    return c.get(p.lir) && p.lir <= p.n && Snapshot_Load_List(c, p.s) && Snapshot_Load_List(c, p.q) &&
+           Snapshot_Load_Ghosts(c, p.ghosts) && Snapshot_Load_Vector(c, p.status) && Snapshot_Load_Vector(c, p.in_s) &&
+           Snapshot_Load_Vector(c, p.page);
+}
+
+// --- MGLRU: aging period, generation lists and each frame's sequence number ---
+inline void Snapshot_Save_Policy(SnapshotBlob& b, const MglruPolicy& p) {
+    b.put(p.min_seq);
+    b.put(p.max_seq);
+    b.put(p.since);
+    b.put(p.interval);
+    b.put(p.stats);
+    for (int g = 0; g < MGLRU_MAX_GENS; ++g) {
+        b.put(p.head[g]);
+        b.put(p.tail[g]);
+        b.put(p.size[g]);
+    }
+    Snapshot_Save_Vector(b, p.prev);
+    Snapshot_Save_Vector(b, p.next);
+    Snapshot_Save_Vector(b, p.seq);
+}
+
+inline bool Snapshot_Load_Policy(SnapshotCursor& c, MglruPolicy& p) {
+    if (!c.get(p.min_seq) || !c.get(p.max_seq) || !c.get(p.since) || !c.get(p.interval) || !c.get(p.stats)) {
+        return false;
+    }
+    if (p.max_seq < p.min_seq || p.max_seq - p.min_seq >= (u64)MGLRU_MAX_GENS) return false;
+    for (int g = 0; g < MGLRU_MAX_GENS; ++g) {
+        if (!c.get(p.head[g]) || !c.get(p.tail[g]) || !c.get(p.size[g]) || p.size[g] > p.prev.size()) return false;
+    }
+    if (!Snapshot_Load_Vector(c, p.prev) || !Snapshot_Load_Vector(c, p.next) || !Snapshot_Load_Vector(c, p.seq) ||
+        !Snapshot_Check_Links(p.prev, p.next)) {
+        return false;
+    }
+    for (int g = 0; g < MGLRU_MAX_GENS; ++g) {
+        if (!Snapshot_Check_List(p.head[g], p.tail[g], p.prev, p.next, &p.size[g])) return false;
+    }
+    return true;
+}
+
+// --- TLB: entries, ASID allocator, switch and coalescing accounting ---
+inline void Snapshot_Save_TLB(SnapshotBlob& b, const TLB& t) {
+    b.put(t.clock);
+    b.put(t.current_pid);
+    b.put(t.current_asid);
+    b.put((u64)t.has_current);
+    b.put(t.since_switch);
+    b.put(t.burst);
+    b.put((u64)t.in_burst);
+    b.put(t.stats);
+    b.put(t.max_run);
+    b.put(t.coalesce);
+    b.put_array(t.array.data(), t.array.size());
+    b.put_array(t.asid_owner.data(), t.asid_owner.size());
+    b.put_array(t.asid_last_used.data(), t.asid_last_used.size());
+    std::vector<uint8_t> taken(t.asid_taken.begin(), t.asid_taken.end());
+    b.put_array(taken.data(), taken.size());
+}
+
+// Valid entries must map inside the frame table
+inline bool Snapshot_Load_TLB(SnapshotCursor& c, TLB& t, u64 frames) {
+    u64 has_current, in_burst;
+    if (!c.get(t.clock) || !c.get(t.current_pid) || !c.get(t.current_asid) || !c.get(has_current) ||
+        !c.get(t.since_switch) || !c.get(t.burst) || !c.get(in_burst) || !c.get(t.stats) || !c.get(t.max_run) ||
+        !c.get(t.coalesce) || t.max_run == 0 || (t.max_run & (t.max_run - 1))) {
+        return false;
+    }
+    t.has_current = has_current != 0;
+    t.in_burst = in_burst != 0;
+    const TLBEntry* entries = c.get_array<TLBEntry>(t.array.size());
+    const u64* owner = c.get_array<u64>(t.asid_owner.size());
+    const u64* last = c.get_array<u64>(t.asid_last_used.size());
+    const uint8_t* taken = c.get_array<uint8_t>(t.asid_taken.size());
+    if (!entries || !owner || !last || !taken) return false;
+    for (size_t i = 0; i < t.array.size(); ++i) {
+        const TLBEntry& e = entries[i];
+        if (!Snapshot_Check_Bool(&e.is_vaild)) return false;
+        if (e.is_vaild && (e.Pages == 0 || e.Pages > t.max_run || e.PFN >= frames || e.Pages > frames - e.PFN)) {
+            return false;
+        }
+    }
+    t.array.assign(entries, entries + t.array.size());
+    t.asid_owner.assign(owner, owner + t.asid_owner.size());
+    t.asid_last_used.assign(last, last + t.asid_last_used.size());
+    for (size_t i = 0; i < t.asid_taken.size(); ++i) t.asid_taken[i] = taken[i] != 0;
+    return true;
+}
+
+inline void Snapshot_Save_TLB(SnapshotBlob&, const NoTLB&) {}
+inline bool Snapshot_Load_TLB(SnapshotCursor&, NoTLB&, u64) { return true; }
+
+inline SnapshotConfig Snapshot_Config_Of(const TLB& t) {
+    SnapshotConfig c;
+    c.tlb_entries = t.array.size();
+    c.tlb_mode = (uint32_t)t.mode;
+    c.asids = (uint32_t)t.num_asids;
+    c.tlb_window = t.window;
+    return c;
+}
+
+inline SnapshotConfig Snapshot_Config_Of(const NoTLB&) { return SnapshotConfig(); }
+
+// --- Prefetcher: settings, per-PID streams, page-cache membership ---
+struct SnapStream {
+    u64 pid;
+    ReadaheadState state;
+};
+
+inline void Snapshot_Save_Prefetch(SnapshotBlob& b, const Prefetcher& p) {
+    b.put(p.fault_around);
+    b.put(p.ra_max);
+    b.put(p.ra_init);
+    std::vector<SnapStream> streams;
+    for (auto& s : p.streams) streams.push_back({s.first, s.second});
+    std::vector<u64> cached;
+    cached.reserve(p.cached.size() * 2);
+    for (auto& k : p.cached) { cached.push_back(k.first); cached.push_back(k.second); }
+    b.put((u64)streams.size());
+    b.put_array(streams.data(), streams.size());
+    b.put((u64)p.cached.size());
+    b.put_array(cached.data(), cached.size());
+}
+
+inline bool Snapshot_Load_Prefetch(SnapshotCursor& c, Prefetcher& p) {
+    u64 n_streams, n_cached;
+    if (!c.get(p.fault_around) || !c.get(p.ra_max) || !c.get(p.ra_init) || !c.get(n_streams)) return false;
+    const SnapStream* streams = c.get_array<SnapStream>(n_streams);
+    if (streams == nullptr || !c.get(n_cached)) return false;
+    const u64* cached = c.get_array<u64>(n_cached * 2);
+    if (cached == nullptr) return false;
+    for (u64 i = 0; i < n_streams; ++i) p.streams[streams[i].pid] = streams[i].state;
+    p.cached.reserve(n_cached);
+    for (u64 i = 0; i < n_cached; ++i) p.cached.insert(std::make_pair(cached[2 * i], cached[2 * i + 1]));
+    return true;
+}
+
+// --- KSM scanner: settings, cursor, checksums, stable/unstable trees ---
+inline void Snapshot_Save_Ksm(SnapshotBlob& b, const KsmScanner& k) {
+    b.put(k.pages);
+    b.put(k.interval);
+    b.put(k.max_sharing);
+    b.put(k.cursor);
+    b.put(k.since);
+    b.put(k.stats);
+    b.put((u64)k.checksum.size());
+    b.put_array(k.checksum.data(), k.checksum.size());
+    for (const std::unordered_map<u64, u64>* tree : {&k.stable, &k.unstable}) {
+        std::vector<u64> pairs;
+        pairs.reserve(tree->size() * 2);
+        for (auto& e : *tree) { pairs.push_back(e.first); pairs.push_back(e.second); }
+        b.put((u64)tree->size());
+        b.put_array(pairs.data(), pairs.size());
+    }
+}
+
+inline bool Snapshot_Load_Ksm(SnapshotCursor& c, KsmScanner& k, u64 frames) {
+    u64 n;
+    const u64* checksum;
+    if (!c.get(k.pages) || !c.get(k.interval) || !c.get(k.max_sharing) || !c.get(k.cursor) || !c.get(k.since) || !c.get(k.stats) ||
+        !c.get(n) || (n != 0 && n != frames) || !(checksum = c.get_array<u64>(n))) {
+        return false;
+    }
+    if (k.cursor >= (frames ? frames : 1)) return false;
+    k.checksum.assign(checksum, checksum + n);
+    for (std::unordered_map<u64, u64>* tree : {&k.stable, &k.unstable}) {
+        const u64* pairs;
+        if (!c.get(n) || !(pairs = c.get_array<u64>(n * 2))) return false;
+        tree->reserve(n);
+        for (u64 i = 0; i < n; ++i) {
+            if (pairs[2 * i + 1] >= frames) return false;
+            (*tree)[pairs[2 * i]] = pairs[2 * i + 1];
+        }
+    }
+    return true;
+}
+
+// --- Zswap: settings, counters, pool entries (oldest first), swap slots ---
+struct SnapZswapEntry {
+    u64 pid, vpn, bytes;
+};
+
+inline void Snapshot_Save_Zswap(SnapshotBlob& b, const ZswapPool& z) {
+    b.put(z.limit);
+    b.put(z.stats);
+    std::vector<SnapZswapEntry> entries;
+    std::vector<unsigned char> data;
+    for (const ZswapPool::Key& k : z.lru) {
+        const std::vector<unsigned char>& blob = z.pool.at(k).blob;
+        entries.push_back({k.first, k.second, blob.size()});
+        data.insert(data.end(), blob.begin(), blob.end());
+    }
+    b.put((u64)entries.size());
+    b.put_array(entries.data(), entries.size());
+    b.put((u64)data.size());
+    b.put_array(data.data(), data.size());
+
+    entries.clear();
+    data.clear();
+    for (auto& s : z.swap) {
+        entries.push_back({s.first.first, s.first.second, s.second.size()});
+        data.insert(data.end(), s.second.begin(), s.second.end());
+    }
+    b.put((u64)entries.size());
+    b.put_array(entries.data(), entries.size());
+    b.put((u64)data.size());
+    b.put_array(data.data(), data.size());
+}
+
+inline bool Snapshot_Load_Zswap(SnapshotCursor& c, ZswapPool& z) {
+    if (!c.get(z.limit) || !c.get(z.stats)) return false;
+    for (int part = 0; part < 2; ++part) {
+        u64 n, total, at = 0;
+        const SnapZswapEntry* entries;
+        const unsigned char* data;
+        if (!c.get(n) || !(entries = c.get_array<SnapZswapEntry>(n)) || !c.get(total) ||
+            !(data = c.get_array<unsigned char>(total))) {
+            return false;
+        }
+        for (u64 i = 0; i < n; ++i) {
+            if (entries[i].bytes > total - at) return false;
+            ZswapPool::Key key(entries[i].pid, entries[i].vpn);
+            std::vector<unsigned char> blob(data + at, data + at + entries[i].bytes);
+            at += entries[i].bytes;
+            if (part == 1) {
+                z.swap[key] = std::move(blob);
+                continue;
+            }
+            if (z.pool.count(key)) return false;
+            z.lru.push_back(key);
+            z.pool_bytes += blob.size();
+            z.pool[key] = ZswapPool::Entry{std::move(blob), std::prev(z.lru.end())};
+        }
+        if (at != total) return false;
+    }
+    return true;
+}
+
+// --- Tiering: per-node latency, daemon settings and state, counters ---
+struct SnapTierConfig {
+    u64 placement, sample, hot, interval, batch, countdown, since;
+    u64 samples, promotions, demotions, runs;
+};
+
+inline void Snapshot_Save_Tiers(SnapshotBlob& b, const TieringDaemon& t) {
+    SnapTierConfig c = {(u64)t.placement, t.sample, t.hot, t.interval, t.batch, t.countdown, t.since,
+                        t.stats.samples, t.stats.promotions, t.stats.demotions, t.stats.runs};
+    b.put(c);
+    b.put((u64)t.latency_ns.size());
+    b.put_array(t.latency_ns.data(), t.latency_ns.size());
+    b.put_array(t.stats.accesses.data(), t.stats.accesses.size());
+    b.put((u64)t.heat.size());
+    b.put_array(t.heat.data(), t.heat.size());
+    b.put_array(t.queued.data(), t.queued.size());
+    b.put((u64)t.promote.size());
+    b.put_array(t.promote.data(), t.promote.size());
+}
+
+inline bool Snapshot_Load_Tiers(SnapshotCursor& c, TieringDaemon& t, u64 frames, u64 nodes) {
+    SnapTierConfig tc;
+    u64 n, heat_size, queue;
+    const double* latency;
+    const u64* accesses;
+    const uint8_t *heat, *queued;
+    const uint32_t* promote;
+    if (!c.get(tc) || !c.get(n) || !(latency = c.get_array<double>(n)) ||
+        !(accesses = c.get_array<u64>(n)) || !c.get(heat_size) || !(heat = c.get_array<uint8_t>(heat_size)) ||
+        !(queued = c.get_array<uint8_t>(heat_size)) || !c.get(queue) || !(promote = c.get_array<uint32_t>(queue))) {
+        return false;
+    }
+    if (n == 0) return heat_size == 0; // Tiering off
+    if (n != nodes || heat_size != frames || tc.sample == 0 || tc.countdown == 0) return false;
+    t.placement = (int)tc.placement;
+    t.sample = tc.sample;
+    t.hot = tc.hot;
+    t.interval = tc.interval;
+    t.batch = tc.batch;
+    t.countdown = tc.countdown;
+    t.since = tc.since;
+    t.latency_ns.assign(latency, latency + n);
+    t.init(frames);
+    t.stats.accesses.assign(accesses, accesses + n);
+    t.stats.samples = tc.samples;
+    t.stats.promotions = tc.promotions;
+    t.stats.demotions = tc.demotions;
+    t.stats.runs = tc.runs;
+    t.heat.assign(heat, heat + frames);
+    t.queued.assign(queued, queued + frames);
+    for (u64 i = 0; i < queue; ++i) {
+        if (promote[i] >= frames) return false;
+    }
+    t.promote.assign(promote, promote + queue);
+    return true;
+}
+
+// --- Cache hierarchy: geometry, counters, then each level's lines ---
+struct SnapCacheLevel {
+    u64 sets, ways;
+    CacheLevelStats stats;
+};
+
+inline void Snapshot_Save_Caches(SnapshotBlob& b, const CacheHierarchy& h) {
+    b.put((u64)h.levels.size());
+    b.put(h.line_shift);
+    b.put(h.clock);
+    b.put(h.walks);
+    for (const CacheLevel& l : h.levels) {
+        SnapCacheLevel sl = {l.sets, l.ways, l.stats};
+        b.put(sl);
+        b.put_array(l.tags.data(), l.tags.size());
+        b.put_array(l.used.data(), l.used.size());
+        b.put_array(l.kind.data(), l.kind.size());
+    }
+}
+
+inline bool Snapshot_Load_Caches(SnapshotCursor& c, CacheHierarchy& h) {
+    u64 n;
+    if (!c.get(n) || n > (u64)CACHE_MAX_LEVELS || !c.get(h.line_shift) || h.line_shift < 3 || h.line_shift > 12 ||
+        !c.get(h.clock) || !c.get(h.walks)) {
+        return false;
+    }
+    h.levels.assign(n, CacheLevel());
+    for (CacheLevel& l : h.levels) {
+        SnapCacheLevel sl;
+        if (!c.get(sl) || sl.ways == 0 || sl.sets == 0 || (sl.sets & (sl.sets - 1)) || sl.sets > (1ULL << 32) ||
+            sl.ways > 1024) {
+            return false;
+        }
+        const u64 lines = sl.sets * sl.ways;
+        const u64 *tags, *used;
+        const uint8_t* kind;
+        if (!(tags = c.get_array<u64>(lines)) || !(used = c.get_array<u64>(lines)) ||
+            !(kind = c.get_array<uint8_t>(lines))) {
+            return false;
+        }
+        l.sets = sl.sets;
+        l.ways = sl.ways;
+        l.stats = sl.stats;
+        l.tags.assign(tags, tags + lines);
+        l.used.assign(used, used + lines);
+        l.kind.assign(kind, kind + lines);
+        for (u64 i = 0; i < lines; ++i) {
+            if (kind[i] >= CACHE_KINDS) return false;
+            l.walk_lines += tags[i] != 0 && kind[i] == CACHE_WALK;
+        }
+    }
+    return true;
+}
+
+/* ===================================================
+   Whole-MMU Save / Load
+   =================================================== */
+
+// One extra mapping of a shared (copy-on-write) frame
+struct SnapSharer {
+    u64 frame, pid, vpn;
+};
+
+template <class Backend, class Tlb, class Policy>
+bool Save_Snapshot(const std::string& path, const Mmu<Backend, Tlb, Policy>& mmu,
+                   const SnapshotTrace& trace, u64 virtual_pages) {
+    SnapshotWriter w;
+
+    SnapshotConfig cfg = Snapshot_Config_Of(mmu.tlb);
+    std::strncpy(cfg.backend, Backend::name(), sizeof(cfg.backend) - 1);
+    std::strncpy(cfg.policy, Policy::name(), sizeof(cfg.policy) - 1);
+    cfg.frames = mmu.frames.capacity();
+    cfg.virtual_pages = virtual_pages;
+    cfg.data = !mmu.ram.empty();
+    w.section(SNAP_CONFIG).put(cfg);
+    w.section(SNAP_TRACE).put(trace);
+    w.section(SNAP_STATS).put(mmu.stats);
+
+    SnapshotBlob& frames = w.section(SNAP_FRAMES);
+    // Node sizes, frame table, then each node's free stack
+    std::vector<u64> node_sizes;
+    for (u64 n = 0; n < mmu.frames.nodes(); ++n) node_sizes.push_back(mmu.frames.node_frames(n));
+    frames.put((u64)node_sizes.size());
+    frames.put_array(node_sizes.data(), node_sizes.size());
+    frames.put_array(mmu.frames.frames.data(), mmu.frames.frames.size());
+    for (const std::vector<uint32_t>& stack : mmu.frames.free_stacks) {
+        frames.put((u64)stack.size());
+        frames.put_array(stack.data(), stack.size());
+    }
+    // Shared-frame reverse map: (frame, pid, vpn), each frame's list in order
+    std::vector<SnapSharer> sharers;
+    for (auto& s : mmu.frames.sharers) {
+        for (const FrameMapping& m : s.second) sharers.push_back({s.first, m.pid, m.vpn});
+    }
+    frames.put((u64)sharers.size());
+    frames.put_array(sharers.data(), sharers.size());
+
+    Snapshot_Save_Policy(w.section(SNAP_POLICY), mmu.frames.policy);
+    Snapshot_Save_TLB(w.section(SNAP_TLB), mmu.tlb);
+    Snapshot_Save_Table(w.section(SNAP_TABLES), mmu.table);
+    Snapshot_Save_Prefetch(w.section(SNAP_PREFETCH), mmu.prefetch);
+    Snapshot_Save_Ksm(w.section(SNAP_KSM), mmu.ksm);
+    Snapshot_Save_Zswap(w.section(SNAP_ZSWAP), mmu.zswap);
+    Snapshot_Save_Tiers(w.section(SNAP_TIERS), mmu.tiers);
+    Snapshot_Save_Caches(w.section(SNAP_CACHE), mmu.caches);
+    if (!mmu.ram.empty()) w.section(SNAP_RAM).put_array(mmu.ram.data(), mmu.ram.size());
+    return w.write(path);
+}
+
+inline bool Read_Snapshot_Config(const SnapshotReader& snap, SnapshotConfig* cfg) {
+    SnapshotCursor c;
+    return snap.find(SNAP_CONFIG, &c) && c.get(*cfg);
+}
+
+// `mmu` must be freshly built from the snapshot's SnapshotConfig.
+template <class Backend, class Tlb, class Policy>
+bool Load_Snapshot(const SnapshotReader& snap, Mmu<Backend, Tlb, Policy>& mmu,
+                   SnapshotTrace* trace, std::string* error) {
+    SnapshotConfig cfg;
+    SnapshotCursor c;
+    if (!Read_Snapshot_Config(snap, &cfg)) { *error = "missing config"; return false; }
+    if (std::strncmp(cfg.backend, Backend::name(), sizeof(cfg.backend)) != 0 ||
+        std::strncmp(cfg.policy, Policy::name(), sizeof(cfg.policy)) != 0 ||
+        cfg.frames != mmu.frames.capacity()) {
+        *error = "snapshot was taken with a different configuration";
+        return false;
+    }
+    if (!snap.find(SNAP_TRACE, &c) || !c.get(*trace)) { *error = "bad trace section"; return false; }
+    if (!snap.find(SNAP_STATS, &c) || !c.get(mmu.stats)) { *error = "bad stats section"; return false; }
+
+    u64 num_nodes, total = 0;
+    const u64* node_sizes;
+    if (!snap.find(SNAP_FRAMES, &c) || !c.get(num_nodes) || num_nodes == 0 || num_nodes > 255 ||
+        !(node_sizes = c.get_array<u64>(num_nodes))) {
+        *error = "bad frame section";
+        return false;
+    }
+    for (u64 n = 0; n < num_nodes; ++n) total += node_sizes[n];
+    const FrameInfo* frames = c.get_array<FrameInfo>(cfg.frames);
+    if (total != cfg.frames || frames == nullptr) { *error = "bad frame section"; return false; }
+    for (u64 f = 0; f < cfg.frames; ++f) {
+        if (!Snapshot_Check_Bool(&frames[f].in_use) || !Snapshot_Check_Bool(&frames[f].dirty) ||
+            !Snapshot_Check_Bool(&frames[f].prefetched)) {
+            *error = "bad frame section";
+            return false;
+        }
+    }
+    mmu.frames.set_nodes(std::vector<u64>(node_sizes, node_sizes + num_nodes));
+    mmu.frames.frames.assign(frames, frames + cfg.frames);
+    mmu.frames.free_frames = 0;
+    for (u64 n = 0; n < num_nodes; ++n) {
+        u64 free_count;
+        const uint32_t* stack;
+        if (!c.get(free_count) || free_count > node_sizes[n] || !(stack = c.get_array<uint32_t>(free_count))) {
+            *error = "bad frame section";
+            return false;
+        }
+        for (u64 k = 0; k < free_count; ++k) {
+            if (stack[k] >= cfg.frames || mmu.frames.node_of[stack[k]] != n) { *error = "bad frame section"; return false; }
+        }
+        mmu.frames.free_stacks[n].assign(stack, stack + free_count);
+        mmu.frames.free_frames += free_count;
+    }
+    u64 shared;
+    const SnapSharer* sharers;
+    if (!c.get(shared) || !(sharers = c.get_array<SnapSharer>(shared))) { *error = "bad frame section"; return false; }
+    for (u64 k = 0; k < shared; ++k) {
+        if (sharers[k].frame >= cfg.frames) { *error = "bad frame section"; return false; }
+        mmu.frames.sharers[sharers[k].frame].push_back({sharers[k].pid, sharers[k].vpn});
+    }
+
+    if (!snap.find(SNAP_POLICY, &c) || !Snapshot_Load_Policy(c, mmu.frames.policy)) {
+        *error = "bad policy section";
+        return false;
+    }
+    if (!snap.find(SNAP_TLB, &c) || !Snapshot_Load_TLB(c, mmu.tlb, cfg.frames)) { *error = "bad TLB section"; return false; }
+    if (!snap.find(SNAP_TABLES, &c) || !Snapshot_Load_Table(c, mmu.table)) {
+        *error = "bad page-table section";
+        return false;
+    }
+    if (!snap.find(SNAP_PREFETCH, &c) || !Snapshot_Load_Prefetch(c, mmu.prefetch)) {
+        *error = "bad prefetch section";
+        return false;
+    }
+    if (!snap.find(SNAP_KSM, &c) || !Snapshot_Load_Ksm(c, mmu.ksm, cfg.frames)) {
+        *error = "bad KSM section";
+        return false;
+    }
+    if (!snap.find(SNAP_ZSWAP, &c) || !Snapshot_Load_Zswap(c, mmu.zswap)) {
+        *error = "bad zswap section";
+        return false;
+    }
+    if (!snap.find(SNAP_TIERS, &c) || !Snapshot_Load_Tiers(c, mmu.tiers, cfg.frames, mmu.frames.nodes())) {
+        *error = "bad tiering section";
+        return false;
+    }
+    if (!snap.find(SNAP_CACHE, &c) || !Snapshot_Load_Caches(c, mmu.caches)) {
+        *error = "bad cache section";
+        return false;
+    }
+    if (cfg.data) {
+        const unsigned char* ram;
+        mmu.enable_data();
+        if (!snap.find(SNAP_RAM, &c) || !(ram = c.get_array<unsigned char>(mmu.ram.size()))) {
+            *error = "bad RAM section";
+            return false;
+        }
+        std::memcpy(mmu.ram.data(), ram, mmu.ram.size());
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Interval Time-Series Statistics
+   ===================================================
+   The simulator keeps cumulative counters. Every `interval` accesses a
+   snapshot is copied into a preallocated ring (no allocation on the hot
+   path). When the ring is full the oldest sample is overwritten and
+   becomes the baseline for the next delta.
+
+   Exports: per-interval deltas for event counters, current levels for
+   gauges (page-table bytes, resident pages). CSV has one row per
+   interval; JSON is column-oriented for dashboards.                    */
+
+struct SimCounters {
+    // Events (cumulative)
+    u64 accesses = 0;
+    u64 hits = 0;
+    u64 faults = 0;
+    u64 evictions = 0;
+    u64 tlb_misses = 0;
+    // Gauges (current level)
+    u64 page_table_bytes = 0;
+    u64 resident_pages = 0;
+};
+
+struct IntervalStats {
+    u64 interval;
+    std::vector<SimCounters> ring;
+    size_t head = 0;   // Next slot to write
+    size_t count = 0;  // Valid samples in the ring
+    u64 dropped = 0;   // Samples overwritten because the ring was full
+    u64 since = 0;
+    SimCounters base;  // Cumulative values just before the oldest sample
+
+    explicit IntervalStats(u64 every, size_t capacity = 65536)
+        : interval(every ? every : 1), ring(capacity ? capacity : 1) {}
+
+    // Call once per access; true when a snapshot is due
+    inline bool due() {
+        if (++since < interval) return false;
+        since = 0;
+        return true;
+    }
+
+    inline void snapshot(const SimCounters& now) {
+        if (count == ring.size()) {
+            base = ring[head]; // Oldest sample is about to go
+            dropped++;
+        } else {
+            count++;
+        }
+        ring[head] = now;
+        head = (head + 1 == ring.size()) ? 0 : head + 1;
+    }
+
+    const SimCounters& at(size_t i) const {
+        size_t oldest = (count == ring.size()) ? head : 0;
+        size_t idx = oldest + i;
+        return ring[idx >= ring.size() ? idx - ring.size() : idx];
+    }
+
+    bool write_csv(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+        std::fprintf(f, "t,hits,faults,evictions,tlb_misses,page_table_bytes,resident_pages\n");
+        SimCounters prev = base;
+        for (size_t i = 0; i < count; ++i) {
+            const SimCounters& c = at(i);
+            std::fprintf(f, "%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                         (unsigned long long)c.accesses,
+                         (unsigned long long)(c.hits - prev.hits),
+                         (unsigned long long)(c.faults - prev.faults),
+                         (unsigned long long)(c.evictions - prev.evictions),
+                         (unsigned long long)(c.tlb_misses - prev.tlb_misses),
+                         (unsigned long long)c.page_table_bytes,
+                         (unsigned long long)c.resident_pages);
+            prev = c;
+        }
+        return std::fclose(f) == 0;
+    }
+
+    bool write_json(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+        std::fprintf(f, "{\n  \"interval\": %llu,\n  \"dropped\": %llu,\n  \"columns\": {\n",
+                     (unsigned long long)interval, (unsigned long long)dropped);
+
+        static const char* names[] = {"t", "hits", "faults", "evictions", "tlb_misses",
+                                      "page_table_bytes", "resident_pages"};
+        for (int col = 0; col < 7; ++col) {
+            std::fprintf(f, "    \"%s\": [", names[col]);
+            SimCounters prev = base;
+            for (size_t i = 0; i < count; ++i) {
+                const SimCounters& c = at(i);
+                u64 v = 0;
+                switch (col) {
+                    case 0: v = c.accesses; break;
+                    case 1: v = c.hits - prev.hits; break;
+                    case 2: v = c.faults - prev.faults; break;
+                    case 3: v = c.evictions - prev.evictions; break;
+                    case 4: v = c.tlb_misses - prev.tlb_misses; break;
+                    case 5: v = c.page_table_bytes; break;
+                    case 6: v = c.resident_pages; break;
+                }
+                std::fprintf(f, "%s%llu", i ? ", " : "", (unsigned long long)v);
+                prev = c;
+            }
+            std::fprintf(f, "]%s\n", col < 6 ? "," : "");
+        }
+        std::fprintf(f, "  }\n}\n");
+        return std::fclose(f) == 0;
+    }
+
+    // Format chosen by extension: .json -> JSON, anything else -> CSV
+    bool write(const std::string& path) const {
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        return json ? write_json(path) : write_csv(path);
+    }
+};
+
+// The drivers' [interval] argument: a whole number of accesses, at least 1
+inline bool Parse_Interval(const char* text, u64* out) {
+    char* end;
+    unsigned long long v = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || text[0] == '-' || v == 0) return false;
+    *out = v;
+    return true;
+}
+
+#endif
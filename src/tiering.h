@@ -0,0 +1,207 @@
+#ifndef TIERING_H
+#define TIERING_H
+
+#include "frame_alloc.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   NUMA Nodes / Memory Tiers
+   ===================================================
+   Physical memory is split into nodes listed nearest first (say local
+   DRAM, remote DRAM, a CXL tier), each with a frame count and an access
+   latency. The trace runs on a CPU of node 0.
+
+   Placement, when a page faults in:
+     first_touch  nearest node with a free frame
+     interleave   node (VPN mod nodes), else the ones after it
+   With every node full the replacement policy picks the victim, and
+   the new page takes its frame wherever it is.
+
+   Every access is charged its node's latency. One access in `sample`
+   also bumps the frame's heat (PEBS-style sampling); a frame outside
+   node 0 that reaches `hot` samples is queued for promotion.
+
+   Every `interval` accesses the daemon runs:
+     1. demotion: while a node has fewer than 1/64 of its frames free,
+        move its pages nearest the replacement policy's victim end (and
+        not sampled lately) to the next node with room;
+     2. promotion: move queued hot pages to the nearest node with a
+        free frame;
+     3. aging: halve every frame's heat.
+   At most `batch` pages move per direction and run. A migration copies
+   the page and remaps every mapping of it.                             */
+
+enum TierPlacement { PLACE_FIRST_TOUCH, PLACE_INTERLEAVE };
+
+struct TierStats {
+    std::vector<u64> accesses; // Per node
+    u64 samples = 0;
+    u64 promotions = 0;
+    u64 demotions = 0;
+    u64 runs = 0;
+};
+
+struct TieringDaemon {
+    std::vector<double> latency_ns; // Per node; empty = tiering off
+    int placement = PLACE_FIRST_TOUCH;
+    u64 sample = 64;
+    u64 hot = 2;
+    u64 interval = 10000; // 0 = no migrations
+    u64 batch = 32;
+
+    u64 countdown = 1;
+    u64 since = 0;
+    std::vector<uint8_t> heat;   // Per frame
+    std::vector<uint8_t> queued; // Per frame: on the promotion queue
+    std::vector<uint32_t> promote;
+    TierStats stats;
+
+    bool enabled() const { return !latency_ns.empty(); }
+
+    void init(u64 frames) {
+        heat.assign(frames, 0);
+        queued.assign(frames, 0);
+        stats.accesses.assign(latency_ns.size(), 0);
+    }
+
+    // Preferred node for a new page
+    inline u64 place(u64 vpn) const {
+        return placement == PLACE_INTERLEAVE ? vpn % latency_ns.size() : 0;
+    }
+
+    // A frame was filled with a new page
+    inline void on_alloc(u64 frame) { heat[frame] = 0; }
+
+    inline void on_access(u64 frame, u64 node) {
+        stats.accesses[node]++;
+        if (--countdown != 0) return;
+        countdown = sample;
+        stats.samples++;
+        if (heat[frame] < 255) heat[frame]++;
+        if (node != 0 && heat[frame] >= hot && !queued[frame]) {
+            queued[frame] = 1;
+            promote.push_back((uint32_t)frame);
+        }
+    }
+
+    inline bool due() {
+        if (interval == 0 || ++since < interval) return false;
+        since = 0;
+        return true;
+    }
+
+    // Average cost of the accesses so far, in ns
+    double average_ns() const {
+        double total = 0;
+        u64 n = 0;
+        for (std::size_t i = 0; i < latency_ns.size(); ++i) {
+            total += stats.accesses[i] * latency_ns[i];
+            n += stats.accesses[i];
+        }
+        return n ? total / n : 0.0;
+    }
+};
+
+// "FRAMES:NS,FRAMES:NS,..." -> node sizes and latencies; false if malformed
+inline bool Parse_Tiers(const std::string& spec, std::vector<u64>* frames, std::vector<double>* latency) {
+    frames->clear();
+    latency->clear();
+    std::size_t at = 0;
+    while (at < spec.size()) {
+        std::size_t end = spec.find(',', at);
+        if (end == std::string::npos) end = spec.size();
+        unsigned long long n;
+        double ns;
+        char tail;
+        if (std::sscanf(spec.substr(at, end - at).c_str(), "%llu:%lf%c", &n, &ns, &tail) != 2 || n == 0) return false;
+        frames->push_back(n);
+        latency->push_back(ns);
+        at = end + 1;
+    }
+    return !frames->empty() && frames->size() <= 255;
+}
+
+// Moves one page to a free frame on `node`; false if the node is full
+template <class M>
+bool Tier_Migrate(M& mmu, u64 frame, u64 node) {
+    long long to = mmu.frames.migrate(frame, node);
+    if (to < 0) return false;
+    if (!mmu.ram.empty()) {
+        u64 bytes = mmu.ram.size() / mmu.frames.capacity();
+        std::memcpy(&mmu.ram[to * bytes], &mmu.ram[frame * bytes], bytes);
+    }
+    mmu.frames.for_each_mapping((u64)to, [&](u64 pid, u64 vpn) {
+        mmu.table.map(pid, vpn, (u64)to);
+        mmu.tlb.invalidate(pid, vpn);
+    });
+    TieringDaemon& t = mmu.tiers;
+    t.heat[to] = t.heat[frame];
+    t.heat[frame] = 0;
+    return true;
+}
+
+// Next node after `node` with a free frame, or -1
+template <class FM>
+long long Tier_Below(const FM& frames, u64 node) {
+    for (u64 n = node + 1; n < frames.nodes(); ++n) {
+        if (frames.node_free(n) > 0) return (long long)n;
+    }
+    return -1;
+}
+
+template <class M>
+void Tier_Run(M& mmu) {
+    TieringDaemon& t = mmu.tiers;
+    auto& frames = mmu.frames;
+    t.stats.runs++;
+
+    // 1. Demotion: keep headroom on every node but the last, moving
+    // the node's pages nearest the policy's victim end
+    for (u64 node = 0; node + 1 < frames.nodes(); ++node) {
+        u64 size = frames.node_frames(node);
+        u64 want = size / 64 ? size / 64 : 1;
+        u64 moved = 0, steps = frames.capacity() / 4;
+        u64 f = frames.policy.coldest();
+        while (f != (u64)decltype(frames.policy)::NIL && steps-- > 0 && frames.node_free(node) < want &&
+               moved < t.batch) {
+            u64 next = frames.policy.warmer(f);
+            if (frames.node_of[f] == node && t.heat[f] == 0) {
+                long long below = Tier_Below(frames, node);
+                if (below < 0 || !Tier_Migrate(mmu, f, (u64)below)) break;
+                moved++;
+                t.stats.demotions++;
+            }
+            f = next;
+        }
+    }
+
+    // 2. Promotion: hot pages to the nearest node with room
+    u64 moved = 0;
+    std::size_t k = 0;
+    for (; k < t.promote.size() && moved < t.batch; ++k) {
+        u64 f = t.promote[k];
+        t.queued[f] = 0;
+        u64 node = frames.node_of[f];
+        if (!frames.frames[f].in_use || node == 0 || t.heat[f] < t.hot) continue;
+        for (u64 n = 0; n < node; ++n) {
+            if (frames.node_free(n) == 0) continue;
+            Tier_Migrate(mmu, f, n);
+            moved++;
+            t.stats.promotions++;
+            break;
+        }
+    }
+    t.promote.erase(t.promote.begin(), t.promote.begin() + k);
+
+    // 3. Aging
+    for (uint8_t& h : t.heat) h >>= 1;
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <cstdint>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   TLB with Context-Switch Model
+   ===================================================
+   FLUSH_ON_SWITCH: no address-space tags; every switch invalidates
+                    the whole TLB (CR3 write without PCID).
+   ASID_TAGGED:     entries carry a hardware ASID (x86 PCID). Only
+                    `num_asids` tags exist; when a new process needs
+                    one and all are taken, the least recently used
+                    tag is recycled and only its entries are flushed.
+
+   Coalescing (CoLT-style, set_coalescing): one entry can cover a run
+   of up to `max_run` pages (a power of two) whose VPNs and PFNs are
+   both contiguous, inside one max_run-aligned group of VPNs. The MMU
+   finds the run at fill time by reading the neighbouring PTEs and
+   calls fill(); a shootdown of any page in a run drops the entry. With
+   max_run 1 (the default) every entry is one page.                    */
+
+enum TLBMode { TLB_FLUSH_ON_SWITCH, TLB_ASID_TAGGED };
+
+struct TLBEntry {
+    u64 PID;
+    u64 ASID;
+    u64 VPN;
+    u64 PFN;
+    bool is_vaild = false;
+    u64 Timestampe = 0; // For LRU
+    u64 Pages = 1;      // Coalesced run: VPN..VPN+Pages-1 -> PFN..PFN+Pages-1
+};
+
+struct TLBSwitchStats {
+    u64 switches = 0;
+    u64 full_flushes = 0;
+    u64 asid_recycles = 0;   // A tag was taken from another process
+    u64 entries_flushed = 0; // Valid entries thrown away by switches
+
+    // Post-switch behaviour: the first `window` accesses after each switch
+    u64 window_accesses = 0;
+    u64 window_misses = 0;
+    // Miss burst: consecutive misses from the switch up to the first hit
+    u64 burst_misses = 0;
+    u64 bursts = 0;
+    u64 max_burst = 0;
+};
+
+struct TLBCoalesceStats {
+    u64 fills = 0;
+    u64 coalesced = 0;     // Fills that covered more than one page
+    u64 pages_filled = 0;  // Pages covered by all fills
+    u64 probes = 0;        // Neighbouring PTEs read to find the runs
+};
+
+struct TLB {
+    std::vector<TLBEntry> array;
+    TLBMode mode;
+    int num_asids;
+    u64 clock = 0;
+
+    // ASID allocator: owner PID and last use per tag
+    std::vector<u64> asid_owner;
+    std::vector<u64> asid_last_used;
+    std::vector<bool> asid_taken;
+
+    u64 current_pid = 0;
+    u64 current_asid = 0;
+    bool has_current = false;
+
+    u64 window;
+    u64 since_switch = 0;
+    u64 burst = 0;
+    bool in_burst = false;
+    TLBSwitchStats stats;
+
+    u64 max_run = 1;
+    TLBCoalesceStats coalesce;
+
+    TLB(int size, TLBMode m, int asids = 1, u64 post_switch_window = 16)
+        : array(size), mode(m), num_asids(asids < 1 ? 1 : asids),
+          asid_owner(num_asids, 0), asid_last_used(num_asids, 0),
+          asid_taken(num_asids, false), window(post_switch_window) {}
+
+    // Runs of up to max_run pages per entry (rounded down to a power of two)
+    void set_coalescing(u64 pages) {
+        max_run = 1;
+        while (max_run * 2 <= pages) max_run *= 2;
+    }
+
+    // 1. Lookup (Reader). Returns PFN or -1.
+    long long lookup(u64 VPN) {
+        for (TLBEntry& e : array) {
+            if (e.is_vaild && VPN - e.VPN < e.Pages && tag_matches(e)) {
+                clock++;
+                e.Timestampe = clock;
+                return (long long)(e.PFN + (VPN - e.VPN));
+            }
+        }
+        return -1;
+    }
+
+    // Probe for the running process without touching LRU order
+    bool contains(u64 VPN) const {
+        for (const TLBEntry& e : array) {
+            if (e.is_vaild && VPN - e.VPN < e.Pages && tag_matches(e)) return true;
+        }
+        return false;
+    }
+
+    // 2. Update (Writer + LRU Eviction)
+    void update(u64 VPN, u64 PFN) { fill(VPN, PFN, 1); }
+
+    // One entry for a contiguous run; smaller entries inside it go
+    void fill(u64 VPN, u64 PFN, u64 pages) {
+        coalesce.fills++;
+        coalesce.pages_filled += pages;
+        if (pages > 1) {
+            coalesce.coalesced++;
+            for (TLBEntry& e : array) {
+                if (e.is_vaild && e.VPN - VPN < pages && tag_matches(e)) e.is_vaild = false;
+            }
+        }
+        TLBEntry* victim = &array[0];
+        for (TLBEntry& e : array) {
+            if (!e.is_vaild) { victim = &e; break; }
+            if (e.Timestampe < victim->Timestampe) victim = &e;
+        }
+        victim->PID = current_pid;
+        victim->ASID = current_asid;
+        victim->VPN = VPN;
+        victim->PFN = PFN;
+        victim->is_vaild = true;
+        victim->Timestampe = clock;
+        victim->Pages = pages;
+    }
+
+    // Shootdown: drop one page of one process (its frame was reclaimed)
+    void invalidate(u64 pid, u64 VPN) {
+        for (TLBEntry& e : array) {
+            if (e.is_vaild && VPN - e.VPN < e.Pages && e.PID == pid) e.is_vaild = false;
+        }
+    }
+
+    // 3. Context Switch (CR3 load)
+    void context_switch(u64 pid) {
+        if (has_current && pid == current_pid) return;
+        has_current = true;
+        current_pid = pid;
+        stats.switches++;
+        close_burst();
+        since_switch = 0;
+        in_burst = true;
+
+        if (mode == TLB_FLUSH_ON_SWITCH) {
+            stats.full_flushes++;
+            for (TLBEntry& e : array) {
+                if (e.is_vaild) stats.entries_flushed++;
+                e.is_vaild = false;
+            }
+            return;
+        }
+
+        // ASID_TAGGED: reuse our tag if we still own one
+        for (int a = 0; a < num_asids; ++a) {
+            if (asid_taken[a] && asid_owner[a] == pid) {
+                current_asid = a;
+                asid_last_used[a] = clock;
+                return;
+            }
+        }
+
+        // Otherwise a free tag, or recycle the least recently used one
+        int pick = -1;
+        for (int a = 0; a < num_asids; ++a) {
+            if (!asid_taken[a]) { pick = a; break; }
+            if (pick == -1 || asid_last_used[a] < asid_last_used[pick]) pick = a;
+        }
+        if (asid_taken[pick]) {
+            stats.asid_recycles++;
+            for (TLBEntry& e : array) {
+                if (e.is_vaild && e.ASID == (u64)pick) {
+                    e.is_vaild = false;
+                    stats.entries_flushed++;
+                }
+            }
+        }
+        asid_taken[pick] = true;
+        asid_owner[pick] = pid;
+        asid_last_used[pick] = clock;
+        current_asid = pick;
+    }
+
+    // 4. Post-switch accounting (called once per translation)
+    void record(bool hit) {
+        if (since_switch < window) {
+            stats.window_accesses++;
+            if (!hit) stats.window_misses++;
+        }
+        since_switch++;
+
+        if (in_burst) {
+            if (hit) close_burst();
+            else burst++;
+        }
+    }
+
+    // Flush the current burst (end of trace or next switch)
+    void close_burst() {
+        if (!in_burst) return;
+        stats.bursts++;
+        stats.burst_misses += burst;
+        if (burst > stats.max_burst) stats.max_burst = burst;
+        burst = 0;
+        in_burst = false;
+    }
+
+    // Pages the valid entries cover right now (entries x 1 without coalescing)
+    u64 reach() const {
+        u64 pages = 0;
+        for (const TLBEntry& e : array) pages += e.is_vaild ? e.Pages : 0;
+        return pages;
+    }
+
+private:
+    bool tag_matches(const TLBEntry& e) const {
+        // Flush mode holds only the running process's entries
+        return mode == TLB_FLUSH_ON_SWITCH || e.ASID == current_asid;
+    }
+};
+
+#endif
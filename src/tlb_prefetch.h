@@ -0,0 +1,215 @@
+#ifndef TLB_PREFETCH_H
+#define TLB_PREFETCH_H
+
+#include "tlb.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   TLB Prefetching
+   ===================================================
+   On every TLB miss a predictor proposes pages the process is likely
+   to miss on next, each one is walked speculatively (never faulting)
+   and its translation goes into a small fully associative prefetch
+   buffer next to the TLB. A later miss that hits the buffer moves the
+   entry into the TLB without a walk. Predictors, trained on the miss
+   stream of each PID:
+
+     sequential  vpn + 1
+     stride      vpn + s once the same stride s was seen twice in a row
+     distance    remembers which distances followed each distance
+                 (two per row, most recent first) and prefetches
+                 vpn + d' for those that followed the current one, so
+                 repeating irregular patterns (+1 +5 +1 +5 ...) work
+
+   Candidates already in the TLB or the buffer are filtered out before
+   walking. A speculative walk is wasted if it finds no mapping or its
+   entry leaves the buffer (FIFO) unused.
+
+     accuracy   buffer hits / speculative walks
+     coverage   buffer hits / (buffer hits + demand walks), the share
+                of TLB misses that no longer walk                      */
+
+enum TLBPrefetchKind { TLB_PF_NONE, TLB_PF_SEQUENTIAL, TLB_PF_STRIDE, TLB_PF_DISTANCE };
+
+const int TLB_PF_MAX_CANDIDATES = 2;
+
+struct TLBPrefetchEntry {
+    u64 PID;
+    u64 VPN;
+    u64 PFN;
+    bool valid = false;
+};
+
+struct TLBPrefetchStats {
+    u64 triggers = 0;       // TLB misses that ran the predictor
+    u64 filtered = 0;       // Candidates already in the TLB or the buffer
+    u64 walks = 0;          // Speculative walks issued
+    u64 unmapped = 0;       // ... that found no translation
+    u64 hits = 0;           // TLB misses served from the buffer
+    u64 evicted_unused = 0; // Entries pushed out of the buffer before use
+};
+
+// Last miss of one process, for the stride and distance predictors
+struct TLBMissHistory {
+    u64 last_vpn = 0;
+    long long last_delta = 0;
+    bool seen = false;
+    bool has_delta = false;
+};
+
+// Distance table row: the distances seen right after `distance`
+struct TLBDistanceRow {
+    long long distance = 0;
+    long long next[TLB_PF_MAX_CANDIDATES] = {0, 0};
+    int count = 0;
+    bool valid = false;
+};
+
+struct TLBPrefetcher {
+    TLBPrefetchKind kind = TLB_PF_NONE;
+    std::vector<TLBPrefetchEntry> buffer;
+    u64 next_slot = 0; // FIFO replacement
+    std::unordered_map<u64, TLBMissHistory> history;
+    std::vector<TLBDistanceRow> distances;
+    TLBPrefetchStats stats;
+};
+
+inline const char* TLBPrefetch_Name(TLBPrefetchKind kind) {
+    static const char* names[] = {"none", "sequential", "stride", "distance"};
+    return names[kind];
+}
+
+inline void TLBPrefetch_Init(TLBPrefetcher* pf, TLBPrefetchKind kind, int buffer_entries = 16,
+                             int distance_rows = 64) {
+    pf->kind = kind;
+    pf->buffer.assign(buffer_entries > 0 ? buffer_entries : 1, TLBPrefetchEntry());
+    pf->next_slot = 0;
+    pf->history.clear();
+    pf->distances.assign(distance_rows > 0 ? distance_rows : 1, TLBDistanceRow());
+    pf->stats = TLBPrefetchStats();
+}
+
+inline bool TLBPrefetch_Contains(const TLBPrefetcher* pf, u64 PID, u64 VPN) {
+    for (const TLBPrefetchEntry& e : pf->buffer) {
+        if (e.valid && e.PID == PID && e.VPN == VPN) return true;
+    }
+    return false;
+}
+
+// Second chance on a TLB miss: the PFN (the entry leaves the buffer for
+// the TLB), or -1
+inline long long TLBPrefetch_Lookup(TLBPrefetcher* pf, u64 PID, u64 VPN) {
+    if (pf->kind == TLB_PF_NONE) return -1;
+    for (TLBPrefetchEntry& e : pf->buffer) {
+        if (!e.valid || e.PID != PID || e.VPN != VPN) continue;
+        e.valid = false;
+        pf->stats.hits++;
+        return (long long)e.PFN;
+    }
+    return -1;
+}
+
+inline void TLBPrefetch_Fill(TLBPrefetcher* pf, u64 PID, u64 VPN, u64 PFN) {
+    TLBPrefetchEntry& slot = pf->buffer[pf->next_slot];
+    pf->next_slot = (pf->next_slot + 1) % pf->buffer.size();
+    if (slot.valid) pf->stats.evicted_unused++; // Used entries were taken out
+    slot.PID = PID;
+    slot.VPN = VPN;
+    slot.PFN = PFN;
+    slot.valid = true;
+}
+
+inline TLBDistanceRow& TLBPrefetch_Row(TLBPrefetcher* pf, long long distance) {
+    return pf->distances[(u64)distance % pf->distances.size()];
+}
+
+// Trains on one miss and writes up to TLB_PF_MAX_CANDIDATES pages to `out`
+inline int TLBPrefetch_Predict(TLBPrefetcher* pf, u64 PID, u64 VPN, u64* out) {
+    int n = 0;
+    if (pf->kind == TLB_PF_SEQUENTIAL) {
+        out[n++] = VPN + 1;
+        return n;
+    }
+    TLBMissHistory& h = pf->history[PID];
+    long long delta = h.seen ? (long long)(VPN - h.last_vpn) : 0;
+    bool has_delta = h.seen && delta != 0;
+
+    if (pf->kind == TLB_PF_STRIDE) {
+        if (has_delta && h.has_delta && delta == h.last_delta) out[n++] = VPN + delta;
+    } else if (pf->kind == TLB_PF_DISTANCE && has_delta) {
+        // Learn: `delta` followed the previous distance
+        if (h.has_delta) {
+            TLBDistanceRow& prev = TLBPrefetch_Row(pf, h.last_delta);
+            if (!prev.valid || prev.distance != h.last_delta) {
+                prev = TLBDistanceRow();
+                prev.distance = h.last_delta;
+                prev.valid = true;
+            }
+            int at = 0;
+            while (at < prev.count && prev.next[at] != delta) at++;
+            if (at == prev.count && prev.count < TLB_PF_MAX_CANDIDATES) prev.count++;
+            for (int i = (at < prev.count ? at : prev.count - 1); i > 0; --i) prev.next[i] = prev.next[i - 1];
+            prev.next[0] = delta;
+        }
+        // Predict: what followed `delta` before
+        const TLBDistanceRow& row = TLBPrefetch_Row(pf, delta);
+        if (row.valid && row.distance == delta) {
+            for (int i = 0; i < row.count; ++i) out[n++] = VPN + row.next[i];
+        }
+    }
+    h.last_vpn = VPN;
+    h.seen = true;
+    if (has_delta) {
+        h.last_delta = delta;
+        h.has_delta = true;
+    }
+    return n;
+}
+
+// After a TLB miss on (PID, VPN): predict, filter, walk and fill.
+// walk(PID, VPN) returns the PFN or -1 and must not fault.
+template <class Walk>
+void TLBPrefetch_Issue(TLBPrefetcher* pf, const TLB* tlb, u64 PID, u64 VPN, Walk walk) {
+    if (pf->kind == TLB_PF_NONE) return;
+    pf->stats.triggers++;
+    u64 candidates[TLB_PF_MAX_CANDIDATES];
+    int n = TLBPrefetch_Predict(pf, PID, VPN, candidates);
+    for (int i = 0; i < n; ++i) {
+        u64 v = candidates[i];
+        if (tlb->contains(v) || TLBPrefetch_Contains(pf, PID, v)) {
+            pf->stats.filtered++;
+            continue;
+        }
+        pf->stats.walks++;
+        long long pfn = walk(PID, v);
+        if (pfn < 0) pf->stats.unmapped++;
+        else TLBPrefetch_Fill(pf, PID, v, (u64)pfn);
+    }
+}
+
+inline u64 TLBPrefetch_Pending(const TLBPrefetcher* pf) {
+    u64 n = 0;
+    for (const TLBPrefetchEntry& e : pf->buffer) n += e.valid;
+    return n;
+}
+
+// Walks that bought nothing: no mapping, or pushed out unused
+inline u64 TLBPrefetch_Wasted(const TLBPrefetcher* pf) {
+    return pf->stats.unmapped + pf->stats.evicted_unused;
+}
+
+inline double TLBPrefetch_Accuracy(const TLBPrefetcher* pf) {
+    return pf->stats.walks ? (double)pf->stats.hits / pf->stats.walks : 0.0;
+}
+
+inline double TLBPrefetch_Coverage(const TLBPrefetcher* pf, u64 demand_walks) {
+    u64 misses = pf->stats.hits + demand_walks;
+    return misses ? (double)pf->stats.hits / misses : 0.0;
+}
+
+#endif
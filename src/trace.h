@@ -0,0 +1,159 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <string>
+#include <vector>
+
+typedef uint64_t u64;
+
+// --- Trace Format (one operation per line) ---
+//   W <pid> <hex VA> <char>              Store a byte
+//   R <pid> <hex VA>                     Load a byte
+//   S <pid> <hex VA> <len> <char>        Store <len> copies of <char>
+//   L <pid> <hex VA> <len>               Load <len> bytes
+//   M <pid> <hex dst> <hex src> <len>    Copy <len> bytes (memcpy)
+//   V <pid> <hex VA>                     Visualize a translation (no access)
+//   C <pid>                              Context switch to <pid>
+//   F <pid> <child>                      Fork: <child> shares <pid>'s pages (COW)
+struct TraceRecord {
+    char op = 'R';
+    u64 pid = 0;
+    u64 va = 0;
+    char data = 0;
+    u64 len = 0; // S/L/M byte count
+    u64 src = 0; // M source VA
+    u64 child = 0; // F new PID
+};
+
+inline bool is_bulk_op(char op) { return op == 'S' || op == 'L' || op == 'M'; }
+
+inline u64 get_trace_vpn(const TraceRecord& rec) { return rec.va >> 12; }
+
+// Hex VA with an optional 0x prefix; false unless the whole token parses
+inline bool Parse_Trace_Hex(const std::string& text, u64& out) {
+    if (text.empty() || text[0] == '-' || text[0] == '+') return false;
+    char* end;
+    errno = 0;
+    unsigned long long v = std::strtoull(text.c_str(), &end, 16);
+    if (end == text.c_str() || *end != '\0' || errno == ERANGE) return false;
+    out = v;
+    return true;
+}
+
+// Reads the next record; returns false at end of file or on a malformed line.
+inline bool Read_Trace_Record(std::istream& in, TraceRecord& rec) {
+    std::string hexAddr;
+    rec.va = 0;
+    rec.data = 0;
+    rec.len = rec.src = 0;
+    if (!(in >> rec.op >> rec.pid)) return false;
+    if (rec.op == 'C') return true;
+    if (rec.op == 'F') return (bool)(in >> rec.child);
+    if (!(in >> hexAddr) || !Parse_Trace_Hex(hexAddr, rec.va)) return false;
+    if (rec.op == 'M' && (!(in >> hexAddr) || !Parse_Trace_Hex(hexAddr, rec.src))) return false;
+    if (is_bulk_op(rec.op) && !(in >> rec.len)) return false;
+    if ((rec.op == 'W' || rec.op == 'S') && !(in >> rec.data)) return false;
+    return true;
+}
+
+// --- Bulk Reader for replay: buffered fread and hand-rolled parsing ---
+// Accepts the same format as Read_Trace_Record ("-" reads stdin).
+class TraceFileReader {
+public:
+    explicit TraceFileReader(const std::string& path)
+        : f(path == "-" ? stdin : std::fopen(path.c_str(), "r")), buf(1 << 20) {}
+    ~TraceFileReader() { if (f && f != stdin) std::fclose(f); }
+
+    bool is_open() const { return f != nullptr; }
+
+    // Byte offset of the next unread record (a resume point for seek)
+    u64 offset() const { return file_base + pos; }
+
+    bool seek(u64 off) {
+        if (f == nullptr || std::fseek(f, (long)off, SEEK_SET) != 0) return false;
+        file_base = off;
+        pos = len = 0;
+        return true;
+    }
+
+    // False at end of file or on a malformed line
+    bool next(TraceRecord& rec) {
+        int c = skip_space();
+        if (c < 0) return false;
+        rec.op = (char)c;
+        rec.va = 0;
+        rec.data = 0;
+        rec.len = rec.src = 0;
+        pos++;
+        if (!read_number(rec.pid, 10)) return false;
+        if (rec.op == 'C') return true;
+        if (rec.op == 'F') return read_number(rec.child, 10);
+
+        if (!read_hex(rec.va)) return false;
+        if (rec.op == 'M' && !read_hex(rec.src)) return false;
+        if (is_bulk_op(rec.op) && !read_number(rec.len, 10)) return false;
+        if (rec.op == 'W' || rec.op == 'S') {
+            c = skip_space();
+            if (c < 0) return false;
+            rec.data = (char)c;
+            pos++;
+        }
+        return true;
+    }
+
+private:
+    FILE* f;
+    std::vector<char> buf;
+    size_t pos = 0, len = 0;
+    u64 file_base = 0; // File offset of buf[0]
+
+    // Keeps at least `want` bytes buffered unless the file ends first
+    bool fill(size_t want) {
+        if (len - pos >= want) return true;
+        size_t rest = len - pos;
+        for (size_t i = 0; i < rest; ++i) buf[i] = buf[pos + i];
+        file_base += pos;
+        pos = 0;
+        len = rest + std::fread(&buf[rest], 1, buf.size() - rest, f);
+        return len >= want;
+    }
+
+    int peek_at(size_t k) { return fill(k + 1) ? (unsigned char)buf[pos + k] : -1; }
+
+    int skip_space() {
+        for (;;) {
+            int c = peek_at(0);
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return c;
+            pos++;
+        }
+    }
+
+    // Hex VA with an optional 0x prefix
+    bool read_hex(u64& out) {
+        int c = skip_space();
+        if (c == '0' && (peek_at(1) == 'x' || peek_at(1) == 'X')) pos += 2;
+        return read_number(out, 16);
+    }
+
+    bool read_number(u64& out, int base) {
+        skip_space();
+        out = 0;
+        int digits = 0;
+        for (;; ++digits, ++pos) {
+            int c = peek_at(0), d;
+            if (c >= '0' && c <= '9') d = c - '0';
+            else if (base == 16 && c >= 'a' && c <= 'f') d = c - 'a' + 10;
+            else if (base == 16 && c >= 'A' && c <= 'F') d = c - 'A' + 10;
+            else break;
+            out = out * base + d;
+        }
+        return digits > 0;
+    }
+};
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "trace.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Synthetic Workload Generator
+   ===================================================
+   Produces TraceRecords in batches, either straight into a replay
+   loop (fill / run) or into a trace file in the W/R/C text format.
+   Every stream is a pure function of its WorkloadSpec, seed included. */
+
+enum WorkloadPattern {
+    WL_SEQUENTIAL, // page 0, 1, 2, ... wrapping at the footprint
+    WL_STRIDED,    // page 0, s, 2s, ... modulo the footprint
+    WL_LOOPING,    // sequential over the first loop_pages pages
+    WL_ZIPFIAN,    // rank-skewed popularity (theta), ranks scattered
+    WL_UNIFORM,    // every page equally likely
+    WL_PHASED,     // rotates sequential/zipfian/looping/uniform, moving region
+    WL_SCAN        // hot set (first loop_pages, uniform) alternating with a
+                   // sequential scan over the rest of the footprint
+};
+
+struct WorkloadSpec {
+    WorkloadPattern pattern = WL_UNIFORM;
+    u64 seed = 1;
+    u64 footprint_pages = 1024; // Distinct pages per PID
+    u64 stride_pages = 16;
+    u64 loop_pages = 64;
+    double zipf_theta = 0.99;
+    u64 phase_length = 1 << 20; // Accesses per phase (WL_PHASED)
+    int num_pids = 1;
+    u64 quantum = 1000;          // Accesses per PID before switching
+    bool emit_switches = true;   // Emit 'C <pid>' when the PID changes
+    double write_ratio = 0.0;
+    u64 base_va = 0x10000000;
+    u64 spread_pages = 1;        // VPN distance between neighbouring pages (>1 = sparse)
+    int forks = 0;               // Pre-fork server: PID 1 writes the footprint, then
+                                 // forks PIDs 2..forks+1 before the workload starts
+};
+
+inline bool Parse_Workload_Pattern(const std::string& name, WorkloadPattern& out) {
+    static const char* names[] = {"seq", "stride", "loop", "zipf", "uniform", "phased", "scan"};
+    for (int i = 0; i < 7; ++i) {
+        if (name == names[i]) { out = (WorkloadPattern)i; return true; }
+    }
+    return false;
+}
+
+// Applies one key=value option to a spec (shared by the CLI drivers).
+// False if the key is not a workload option or the value is invalid.
+inline bool Parse_Workload_Option(const std::string& key, const std::string& val, WorkloadSpec& spec) {
+    if (key == "pattern")       return Parse_Workload_Pattern(val, spec.pattern);
+    else if (key == "seed")     spec.seed = std::stoull(val);
+    else if (key == "pages")    spec.footprint_pages = std::stoull(val);
+    else if (key == "stride")   spec.stride_pages = std::stoull(val);
+    else if (key == "loop")     spec.loop_pages = std::stoull(val);
+    else if (key == "theta")    spec.zipf_theta = std::stod(val);
+    else if (key == "phase")    spec.phase_length = std::stoull(val);
+    else if (key == "pids")     spec.num_pids = std::stoi(val);
+    else if (key == "quantum")  spec.quantum = std::stoull(val);
+    else if (key == "switches") spec.emit_switches = (val != "0");
+    else if (key == "writes")   spec.write_ratio = std::stod(val);
+    else if (key == "base")     spec.base_va = std::stoull(val, nullptr, 16);
+    else if (key == "spread")   spec.spread_pages = std::stoull(val);
+    else if (key == "forks")    spec.forks = std::stoi(val);
+    else return false;
+    return true;
+}
+
+// --- Fast RNG (wyrand): one multiply per 64 random bits ---
+struct WyRand {
+    u64 state;
+    explicit WyRand(u64 seed) : state(seed) {}
+    inline u64 next() {
+        state += 0xA0761D6478BD642FULL;
+        __uint128_t m = (__uint128_t)state * (state ^ 0xE7037ED1A0B428DBULL);
+        return (u64)(m >> 64) ^ (u64)m;
+    }
+    // Unbiased enough for simulation: Lemire's multiply-shift range map
+    inline u64 below(u64 n) { return (u64)(((__uint128_t)next() * n) >> 64); }
+};
+
+/* ---------------------------------------------------
+   Zipf Sampler
+   Rank r has weight 1/(r+1)^theta and lives at page (r * scatter) mod n,
+   so the hot pages are spread over the footprint instead of packed at
+   its start. Walker's alias table (built directly over pages) gives O(1)
+   exact draws up to ZIPF_ALIAS_MAX pages; beyond that, Gray et al.'s
+   closed-form approximation costs one pow per draw.                    */
+const u64 ZIPF_ALIAS_MAX = 1 << 22;
+
+struct ZipfSampler {
+    u64 n = 1;
+    double theta = 0.99;
+    u64 scatter = 1;
+    std::vector<uint32_t> prob;  // Scaled to 2^32
+    std::vector<uint32_t> alias;
+    // Closed-form parameters
+    double alpha = 0, zetan = 0, eta = 0;
+
+    void init(u64 num_items, double t, u64 scatter_mult) {
+        n = num_items ? num_items : 1;
+        theta = (t == 1.0) ? 0.9999 : t; // Closed form divides by (1 - theta)
+        scatter = scatter_mult;
+        if (n <= ZIPF_ALIAS_MAX) build_alias();
+        else build_closed_form();
+    }
+
+    // Returns a page in [0, n)
+    inline u64 sample(WyRand& rng) const {
+        if (!prob.empty()) {
+            u64 r = rng.next();
+            u64 i = (u64)(((__uint128_t)(r & 0xFFFFFFFF00000000ULL) * n) >> 64);
+            return ((uint32_t)r < prob[i]) ? i : alias[i];
+        }
+        double u = (double)(rng.next() >> 11) * (1.0 / 9007199254740992.0);
+        double uz = u * zetan;
+        u64 rank;
+        if (uz < 1.0) rank = 0;
+        else if (uz < 1.0 + std::pow(0.5, theta)) rank = 1;
+        else {
+            rank = (u64)(n * std::pow(eta * u - eta + 1.0, alpha));
+            if (rank >= n) rank = n - 1;
+        }
+        return (u64)(((__uint128_t)rank * scatter) % n);
+    }
+
+private:
+    void build_alias() {
+        std::vector<double> p(n);
+        double sum = 0;
+        for (u64 r = 0; r < n; ++r) {
+            double w = 1.0 / std::pow((double)(r + 1), theta);
+            p[(r * scatter) % n] = w;
+            sum += w;
+        }
+
+        prob.assign(n, 0);
+        alias.assign(n, 0);
+        std::vector<uint32_t> small, large;
+        for (u64 i = 0; i < n; ++i) {
+            p[i] = p[i] * n / sum;
+            (p[i] < 1.0 ? small : large).push_back((uint32_t)i);
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(); small.pop_back();
+            uint32_t l = large.back();
+            prob[s] = (uint32_t)(p[s] * 4294967295.0);
+            alias[s] = l;
+            p[l] -= 1.0 - p[s];
+            if (p[l] < 1.0) { large.pop_back(); small.push_back(l); }
+        }
+        for (uint32_t i : large) { prob[i] = 0xFFFFFFFFu; alias[i] = i; }
+        for (uint32_t i : small) { prob[i] = 0xFFFFFFFFu; alias[i] = i; }
+    }
+
+    void build_closed_form() {
+        zetan = 0;
+        for (u64 i = 1; i <= n; ++i) zetan += 1.0 / std::pow((double)i, theta);
+        double zeta2 = 1.0 + std::pow(0.5, theta);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+};
+
+/* ---------------------------------------------------
+   The Generator */
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadSpec& s) : spec(s), rng(s.seed) {
+        if (spec.forks > 0) spec.num_pids = spec.forks + 1;
+        if (spec.num_pids < 1) spec.num_pids = 1;
+        if (spec.footprint_pages == 0) spec.footprint_pages = 1;
+        if (spec.quantum == 0) spec.quantum = 1;
+        if (spec.spread_pages == 0) spec.spread_pages = 1;
+        if (spec.loop_pages == 0 || spec.loop_pages > spec.footprint_pages) spec.loop_pages = spec.footprint_pages;
+        cursor.assign(spec.num_pids, 0);
+        // A stride that wraps onto the same page (a multiple of the
+        // footprint) walks it page by page instead
+        spec.stride_pages %= spec.footprint_pages;
+        if (spec.stride_pages == 0) spec.stride_pages = 1;
+        if (spec.pattern == WL_ZIPFIAN || spec.pattern == WL_PHASED) {
+            zipf.init(spec.footprint_pages, spec.zipf_theta, pick_scatter(spec.footprint_pages));
+        }
+        write_threshold = (u64)(spec.write_ratio * 65536.0);
+    }
+
+    // Fills up to n records; 'C' switch records count toward n. Never fails.
+    size_t fill(TraceRecord* out, size_t n) {
+        size_t k = 0;
+        while (k < n) {
+            if (!started) {
+                started = true;
+                if (spec.emit_switches && spec.num_pids > 1) {
+                    TraceRecord& c = out[k++];
+                    c.op = 'C'; c.pid = pid_of(current_pid); c.va = 0; c.data = 0;
+                    continue;
+                }
+            }
+            if (prologue < prologue_length()) {
+                emit_prologue(out[k++]);
+                continue;
+            }
+            if (in_quantum == spec.quantum) {
+                in_quantum = 0;
+                current_pid = (current_pid + 1) % spec.num_pids;
+                if (spec.emit_switches && spec.num_pids > 1) {
+                    TraceRecord& c = out[k++];
+                    c.op = 'C'; c.pid = pid_of(current_pid); c.va = 0; c.data = 0;
+                    continue;
+                }
+            }
+            size_t run = n - k;
+            if (run > spec.quantum - in_quantum) run = spec.quantum - in_quantum;
+            emit_accesses(out + k, run);
+            k += run;
+            in_quantum += run;
+        }
+        return k;
+    }
+
+    // Streams `count` records into sink(const TraceRecord&) in cache-sized batches.
+    template <class Sink>
+    void run(u64 count, Sink&& sink) {
+        TraceRecord batch[1024];
+        while (count > 0) {
+            size_t n = count < 1024 ? (size_t)count : 1024;
+            fill(batch, n);
+            for (size_t i = 0; i < n; ++i) sink(batch[i]);
+            count -= n;
+        }
+    }
+
+    // Discards the next `count` records (resuming a stream mid-way)
+    void skip(u64 count) {
+        TraceRecord batch[1024];
+        while (count > 0) {
+            size_t n = count < 1024 ? (size_t)count : 1024;
+            fill(batch, n);
+            count -= n;
+        }
+    }
+
+    u64 accesses() const { return generated; }
+    const WorkloadSpec& config() const { return spec; }
+
+private:
+    WorkloadSpec spec;
+    WyRand rng;
+    ZipfSampler zipf;
+    std::vector<u64> cursor; // Per-PID position for the deterministic patterns
+    int current_pid = 0;
+    bool started = false;
+    u64 prologue = 0; // Pre-fork records emitted so far
+    u64 in_quantum = 0;
+    u64 generated = 0;
+    u64 write_threshold = 0;
+
+    u64 pid_of(int idx) const { return (u64)idx + 1; }
+
+    u64 prologue_length() const { return spec.forks > 0 ? spec.footprint_pages + spec.forks : 0; }
+
+    // Pre-fork server start-up: the master writes every page, then forks
+    void emit_prologue(TraceRecord& rec) {
+        u64 i = prologue++;
+        rec.pid = pid_of(0);
+        rec.data = 'm';
+        if (i < spec.footprint_pages) {
+            rec.op = 'W';
+            rec.va = spec.base_va + (i * spec.spread_pages << 12);
+        } else {
+            rec.op = 'F';
+            rec.va = 0;
+            rec.child = pid_of((int)(i - spec.footprint_pages + 1));
+        }
+    }
+
+    // A multiplier coprime with the footprint, so rank -> page is a bijection
+    static u64 pick_scatter(u64 n) {
+        u64 m = 0x9E3779B97F4A7C15ULL % n;
+        if (m == 0) m = 1;
+        for (;; ++m) {
+            u64 a = m, b = n;
+            while (b) { u64 t = a % b; a = b; b = t; }
+            if (a == 1) return m;
+        }
+    }
+
+    inline u64 next_page(WorkloadPattern p, u64& cur, u64 r) {
+        const u64 n = spec.footprint_pages;
+        switch (p) {
+            case WL_SEQUENTIAL: { u64 v = cur; cur = (cur + 1 == n) ? 0 : cur + 1; return v; }
+            case WL_STRIDED:    { u64 v = cur; cur += spec.stride_pages; if (cur >= n) cur -= n; return v; }
+            case WL_LOOPING:    { u64 v = cur; cur = (cur + 1 >= spec.loop_pages) ? 0 : cur + 1; return v; }
+            case WL_ZIPFIAN:    return zipf.sample(rng);
+            case WL_UNIFORM:    return (u64)(((__uint128_t)r * n) >> 64);
+            case WL_SCAN: {
+                const u64 hot = spec.loop_pages;
+                if ((r >> 63) == 0 || hot == n) return (u64)(((__uint128_t)(r << 1) * hot) >> 64);
+                u64 v = hot + cur;
+                cur = (cur + 1 == n - hot) ? 0 : cur + 1;
+                return v;
+            }
+            default:            return 0;
+        }
+    }
+
+    void emit_accesses(TraceRecord* out, size_t n) {
+        const u64 pid = pid_of(current_pid);
+        u64& cur = cursor[current_pid];
+        WorkloadPattern p = spec.pattern;
+        u64 region = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            if (spec.pattern == WL_PHASED) {
+                // Each phase uses a different pattern over a fresh region
+                u64 phase = generated / spec.phase_length;
+                static const WorkloadPattern rotation[] = {WL_SEQUENTIAL, WL_ZIPFIAN, WL_LOOPING, WL_UNIFORM};
+                p = rotation[phase % 4];
+                region = (phase % 8) * spec.footprint_pages;
+            }
+            u64 r = rng.next();
+            u64 page = region + next_page(p, cur, r);
+
+            TraceRecord& rec = out[i];
+            rec.op = ((r & 0xFFFF) < write_threshold) ? 'W' : 'R';
+            rec.pid = pid;
+            rec.va = spec.base_va + (page * spec.spread_pages << 12) + ((r >> 16) & 0xFF8);
+            rec.data = 'a' + (char)(r >> 40 & 15);
+            generated++;
+        }
+    }
+};
+
+/* ---------------------------------------------------
+   Trace File Writer (text format, see trace.h)      */
+inline char* append_u64(char* p, u64 v, int base) {
+    char tmp[20];
+    int len = 0;
+    do {
+        int d = (int)(v % base);
+        tmp[len++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        v /= base;
+    } while (v);
+    while (len) *p++ = tmp[--len];
+    return p;
+}
+
+inline char* format_trace_record(char* p, const TraceRecord& rec) {
+    *p++ = rec.op; *p++ = ' ';
+    p = append_u64(p, rec.pid, 10);
+    if (rec.op == 'F') {
+        *p++ = ' ';
+        p = append_u64(p, rec.child, 10);
+    } else if (rec.op != 'C') {
+        *p++ = ' '; *p++ = '0'; *p++ = 'x';
+        p = append_u64(p, rec.va, 16);
+        if (rec.op == 'M') { *p++ = ' '; *p++ = '0'; *p++ = 'x'; p = append_u64(p, rec.src, 16); }
+        if (is_bulk_op(rec.op)) { *p++ = ' '; p = append_u64(p, rec.len, 10); }
+        if (rec.op == 'W' || rec.op == 'S') { *p++ = ' '; *p++ = rec.data; }
+    }
+    *p++ = '\n';
+    return p;
+}
+
+// Writes `count` records (switch records included). Returns false on I/O error.
+inline bool Write_Trace_File(const std::string& path, const WorkloadSpec& spec, u64 count) {
+    FILE* f = (path == "-") ? stdout : std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    WorkloadGenerator gen(spec);
+    TraceRecord batch[4096];
+    static char buf[4096 * 96]; // Longest record (M) is under 96 bytes
+    bool ok = true;
+
+    while (count > 0 && ok) {
+        size_t n = count < 4096 ? (size_t)count : 4096;
+        gen.fill(batch, n);
+        char* p = buf;
+        for (size_t i = 0; i < n; ++i) p = format_trace_record(p, batch[i]);
+        ok = std::fwrite(buf, 1, p - buf, f) == (size_t)(p - buf);
+        count -= n;
+    }
+    if (f != stdout) ok = (std::fclose(f) == 0) && ok;
+    return ok;
+}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef WSCLOCK_H
+#define WSCLOCK_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef uint64_t u64;
+
+// (PID, VPN) key shared by the per-process structures below
+struct PageKey {
+    u64 pid;
+    u64 vpn;
+    bool operator==(const PageKey& o) const { return pid == o.pid && vpn == o.vpn; }
+};
+
+struct PageKeyHash {
+    size_t operator()(const PageKey& k) const {
+        // splitmix-style mix so neighbouring VPNs spread across buckets
+        u64 x = k.vpn ^ (k.pid * 0x9E3779B97F4A7C15ULL);
+        x ^= x >> 31; x *= 0xBF58476D1CE4E5B9ULL; x ^= x >> 29;
+        return (size_t)x;
+    }
+};
+
+/* ===================================================
+   WSClock Replacement (Carr & Hennessy)
+   ===================================================
+   A clock hand sweeps the frame table. Each process has its own virtual
+   time (number of references it has issued). A frame whose reference bit
+   is clear and whose age in its owner's virtual time exceeds tau is outside
+   the working set and may be reclaimed; dirty ones are cleaned first.    */
+
+struct WSClockFrame {
+    u64 pid = 0;
+    u64 vpn = 0;
+    bool in_use = false;
+    bool referenced = false;
+    bool dirty = false;
+    u64 last_use = 0; // Owner's virtual time at the last observed reference
+};
+
+struct WSClockStats {
+    u64 hits = 0;
+    u64 faults = 0;
+    u64 evictions = 0;
+    u64 evictions_forced = 0; // No clean frame was outside its working set
+    u64 writebacks = 0;       // Dirty pages cleaned by the hand
+    u64 hand_steps = 0;
+};
+
+struct WSClock {
+    std::vector<WSClockFrame> frames;
+    std::unordered_map<PageKey, int, PageKeyHash> resident;
+    std::unordered_map<u64, u64> vtime; // PID -> virtual time
+    u64 tau;
+    int hand = 0;
+    int used = 0;
+    WSClockStats stats;
+
+    WSClock(int num_frames, u64 tau_window) : frames(num_frames), tau(tau_window) {
+        resident.reserve(num_frames * 2);
+    }
+
+    // One reference. Returns true on hit, false if a fault brought the page in.
+    bool access(u64 pid, u64 vpn, bool write) {
+        u64 now = ++vtime[pid];
+
+        auto it = resident.find({pid, vpn});
+        if (it != resident.end()) {
+            WSClockFrame& f = frames[it->second];
+            f.referenced = true;
+            f.dirty |= write;
+            stats.hits++;
+            return true;
+        }
+
+        stats.faults++;
+        int frame = (used < (int)frames.size()) ? used++ : select_victim();
+
+        WSClockFrame& f = frames[frame];
+        f.pid = pid;
+        f.vpn = vpn;
+        f.in_use = true;
+        f.referenced = true;
+        f.dirty = write;
+        f.last_use = now;
+        resident[{pid, vpn}] = frame;
+        return false;
+    }
+
+    int resident_pages(u64 pid) const {
+        int count = 0;
+        for (const WSClockFrame& f : frames) {
+            if (f.in_use && f.pid == pid) count++;
+        }
+        return count;
+    }
+
+private:
+    // Sweep at most two revolutions. The first clears reference bits and
+    // schedules cleaning; the second finds the pages cleaned on the way.
+    // If every page is still inside its working set, take the oldest one.
+    int select_victim() {
+        int n = (int)frames.size();
+        int oldest = -1;
+        u64 oldest_age = 0;
+
+        for (int step = 0; step < 2 * n; ++step) {
+            int idx = hand;
+            hand = (hand + 1) % n;
+            stats.hand_steps++;
+
+            WSClockFrame& f = frames[idx];
+            u64 owner_now = vtime[f.pid];
+
+            if (f.referenced) {
+                f.referenced = false;
+                f.last_use = owner_now;
+                continue;
+            }
+
+            u64 age = owner_now - f.last_use;
+            if (age > tau) {
+                if (f.dirty) {
+                    // Write-back is modelled as completing before the hand returns
+                    f.dirty = false;
+                    stats.writebacks++;
+                    continue;
+                }
+                evict(idx);
+                return idx;
+            }
+            if (oldest == -1 || age > oldest_age) {
+                oldest = idx;
+                oldest_age = age;
+            }
+        }
+
+        if (oldest == -1) oldest = hand;
+        stats.evictions_forced++;
+        if (frames[oldest].dirty) stats.writebacks++;
+        evict(oldest);
+        return oldest;
+    }
+
+    void evict(int frame) {
+        resident.erase({frames[frame].pid, frames[frame].vpn});
+        frames[frame].in_use = false;
+        stats.evictions++;
+    }
+};
+
+/* ===================================================
+   Denning Working Set W(t, tau) per Process
+   ===================================================
+   The number of distinct pages a process referenced in its last tau
+   references (its own virtual time). Each reference enters a FIFO window;
+   when it ages out and was the page's latest reference, the page leaves
+   the set. O(1) amortized per reference, O(tau) memory per process.      */
+
+struct WorkingSetTracker {
+    struct ProcessWindow {
+        u64 vtime = 0;
+        std::deque<std::pair<u64, u64>> window;      // (vtime, vpn)
+        std::unordered_map<u64, u64> last_ref;       // vpn -> vtime
+        u64 peak = 0;
+    };
+
+    u64 tau;
+    std::unordered_map<u64, ProcessWindow> procs;
+
+    explicit WorkingSetTracker(u64 tau_window) : tau(tau_window) {}
+
+    void access(u64 pid, u64 vpn) {
+        ProcessWindow& p = procs[pid];
+        u64 now = ++p.vtime;
+
+        // Expire references older than (now - tau, now]
+        while (!p.window.empty() && p.window.front().first + tau <= now) {
+            auto old = p.window.front();
+            p.window.pop_front();
+            auto it = p.last_ref.find(old.second);
+            if (it != p.last_ref.end() && it->second == old.first) p.last_ref.erase(it);
+        }
+
+        p.window.push_back({now, vpn});
+        p.last_ref[vpn] = now;
+        if (p.last_ref.size() > p.peak) p.peak = p.last_ref.size();
+    }
+
+    u64 size(u64 pid) const {
+        auto it = procs.find(pid);
+        return it == procs.end() ? 0 : it->second.last_ref.size();
+    }
+
+    u64 peak(u64 pid) const {
+        auto it = procs.find(pid);
+        return it == procs.end() ? 0 : it->second.peak;
+    }
+};
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef ZSWAP_H
+#define ZSWAP_H
+
+#include "latency.h"
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef uint64_t u64;
+
+/* ===================================================
+   Compressed Swap Pool (zswap-style)
+   ===================================================
+   Sits between RAM and the swap device. An evicted page is compressed
+   with the LZ codec below into a pool capped at `limit` bytes; a fault
+   on it decompresses it back (no I/O) and drops the pool copy. When a
+   store would overflow the pool, its least recently stored entries are
+   decompressed and written back to the swap device, from which a later
+   fault reads them (a swap-in). Pages that do not compress below a
+   page go straight to swap.
+
+   Only meaningful with frame contents modelled (Mmu::enable_data).    */
+
+/* ---------------------------------------------------
+   LZ codec (LZ4-style block format)
+   Sequence: token (literal length << 4 | match length - 4), extra
+   length bytes when a nibble is 15, the literals, a 16-bit offset and
+   extra match-length bytes. The last sequence is literals only.        */
+
+const int LZ_MIN_MATCH = 4;
+const int LZ_HASH_BITS = 12;
+const u64 LZ_LAST_LITERALS = 5; // The tail is never matched
+
+// Worst-case compressed size of `n` bytes
+inline u64 Lz_Bound(u64 n) { return n + n / 255 + 16; }
+
+inline uint32_t Lz_Read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline unsigned char* Lz_Put_Length(unsigned char* op, u64 len) {
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+// Compresses `n` bytes into `out` (room for Lz_Bound(n)); returns its size
+inline u64 Lz_Compress(const unsigned char* in, u64 n, unsigned char* out) {
+    uint32_t table[1 << LZ_HASH_BITS] = {}; // Position + 1 of the last 4-byte sequence
+    unsigned char* op = out;
+    u64 anchor = 0, i = 0;
+
+    auto emit = [&](u64 lit_end, u64 offset, u64 match) {
+        u64 lit = lit_end - anchor;
+        bool has_match = offset != 0;
+        u64 ml = has_match ? match - LZ_MIN_MATCH : 0;
+        unsigned char* token = op++;
+        *token = (unsigned char)(((lit < 15 ? lit : 15) << 4) | (ml < 15 ? ml : 15));
+        if (lit >= 15) op = Lz_Put_Length(op, lit - 15);
+        std::memcpy(op, in + anchor, lit);
+        op += lit;
+        if (!has_match) return;
+        *op++ = (unsigned char)offset;
+        *op++ = (unsigned char)(offset >> 8);
+        if (ml >= 15) op = Lz_Put_Length(op, ml - 15);
+    };
+
+    if (n > LZ_LAST_LITERALS + LZ_MIN_MATCH) {
+        const u64 limit = n - LZ_LAST_LITERALS;
+        while (i + LZ_MIN_MATCH <= limit) {
+            uint32_t seq = Lz_Read32(in + i);
+            uint32_t h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+            u64 ref = table[h];
+            table[h] = (uint32_t)(i + 1);
+            if (ref == 0 || i - (ref - 1) > 0xFFFF || Lz_Read32(in + ref - 1) != seq) {
+                i++;
+                continue;
+            }
+            ref--;
+            u64 len = LZ_MIN_MATCH;
+            while (i + len + 8 <= limit) { // Eight bytes per step
+                u64 a, b;
+                std::memcpy(&a, in + ref + len, 8);
+                std::memcpy(&b, in + i + len, 8);
+                if (a != b) break;
+                len += 8;
+            }
+            while (i + len < limit && in[ref + len] == in[i + len]) len++;
+            emit(i, i - ref, len);
+            i += len;
+            anchor = i;
+        }
+    }
+    emit(n, 0, 0);
+    return (u64)(op - out);
+}
+
+// Decompresses into `out` (capacity `cap`); returns the size, or ~0 if corrupt
+inline u64 Lz_Decompress(const unsigned char* in, u64 n, unsigned char* out, u64 cap) {
+    const unsigned char* ip = in;
+    const unsigned char* end = in + n;
+    u64 o = 0;
+    auto get_length = [&](u64 len) -> u64 {
+        if (len != 15) return len;
+        unsigned char b;
+        do {
+            if (ip >= end) return ~0ULL;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return len;
+    };
+    while (ip < end) {
+        unsigned char token = *ip++;
+        u64 lit = get_length(token >> 4);
+        if (lit == ~0ULL || lit > (u64)(end - ip) || lit > cap - o) return ~0ULL;
+        std::memcpy(out + o, ip, lit);
+        ip += lit;
+        o += lit;
+        if (ip == end) break; // Last sequence: literals only
+        if (end - ip < 2) return ~0ULL;
+        u64 offset = ip[0] | (u64)ip[1] << 8;
+        ip += 2;
+        u64 match = get_length(token & 15);
+        if (match == ~0ULL) return ~0ULL;
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > o || match > cap - o) return ~0ULL;
+        if (offset >= match) {
+            std::memcpy(out + o, out + o - offset, match);
+        } else if (offset == 1) {
+            std::memset(out + o, out[o - 1], match); // A run of one byte
+        } else {
+            // Overlapping: byte by byte, so the copy feeds itself
+            for (u64 k = 0; k < match; ++k) out[o + k] = out[o + k - offset];
+        }
+        o += match;
+    }
+    return o;
+}
+
+/* ---------------------------------------------------
+   The pool                                                             */
+
+struct ZswapStats {
+    u64 stored = 0;       // Evicted pages compressed into the pool
+    u64 rejected = 0;     // ... incompressible, written to swap instead
+    u64 pool_hits = 0;    // Faults served by decompression
+    u64 swap_ins = 0;     // Faults read back from the swap device
+    u64 writebacks = 0;   // Pool entries pushed out to swap
+    u64 bytes_in = 0;     // Uncompressed bytes stored
+    u64 bytes_out = 0;    // ... their compressed size
+    u64 peak_bytes = 0;
+    LatencyHistogram compress;   // Ticks (profile_now) per page
+    LatencyHistogram decompress;
+};
+
+struct ZswapKeyHash {
+    size_t operator()(const std::pair<u64, u64>& k) const {
+        return (size_t)((k.first * 0x9E3779B97F4A7C15ULL) ^ k.second);
+    }
+};
+
+struct ZswapPool {
+    typedef std::pair<u64, u64> Key; // (PID, VPN)
+    struct Entry {
+        std::vector<unsigned char> blob;
+        std::list<Key>::iterator age;
+    };
+
+    u64 limit = 0;  // Pool capacity in bytes; 0 = off
+    u64 pool_bytes = 0;
+    std::unordered_map<Key, Entry, ZswapKeyHash> pool;
+    std::list<Key> lru; // Oldest store at the front
+    std::unordered_map<Key, std::vector<unsigned char>, ZswapKeyHash> swap; // Raw pages
+    ZswapStats stats;
+
+    bool enabled() const { return limit > 0; }
+
+    // An evicted page: compress it into the pool, else write it to swap
+    void store(u64 pid, u64 vpn, const unsigned char* page, u64 bytes) {
+        Key key(pid, vpn);
+        drop(pid, vpn);
+        std::vector<unsigned char> blob(Lz_Bound(bytes));
+        u64 t0 = profile_now();
+        u64 size = Lz_Compress(page, bytes, blob.data());
+        stats.compress.record(profile_now() - t0);
+        if (size >= bytes || size > limit) {
+            stats.rejected++;
+            swap[key].assign(page, page + bytes);
+            return;
+        }
+        blob.resize(size);
+        blob.shrink_to_fit();
+        while (pool_bytes + size > limit) write_back_oldest(bytes);
+        lru.push_back(key);
+        pool[key] = Entry{std::move(blob), std::prev(lru.end())};
+        pool_bytes += size;
+        if (pool_bytes > stats.peak_bytes) stats.peak_bytes = pool_bytes;
+        stats.stored++;
+        stats.bytes_in += bytes;
+        stats.bytes_out += size;
+    }
+
+    // Fills `page` with the stored copy of (pid, vpn) and forgets it.
+    // False if neither the pool nor swap holds one.
+    bool load(u64 pid, u64 vpn, unsigned char* page, u64 bytes) {
+        Key key(pid, vpn);
+        auto it = pool.find(key);
+        if (it != pool.end()) {
+            u64 t0 = profile_now();
+            Lz_Decompress(it->second.blob.data(), it->second.blob.size(), page, bytes);
+            stats.decompress.record(profile_now() - t0);
+            stats.pool_hits++;
+            erase(it);
+            return true;
+        }
+        auto s = swap.find(key);
+        if (s == swap.end()) return false;
+        std::memcpy(page, s->second.data(), bytes);
+        swap.erase(s);
+        stats.swap_ins++;
+        return true;
+    }
+
+    // The page was unmapped: its stored copy is garbage
+    void drop(u64 pid, u64 vpn) {
+        Key key(pid, vpn);
+        auto it = pool.find(key);
+        if (it != pool.end()) erase(it);
+        swap.erase(key);
+    }
+
+    // True if `pid` has any page in the pool or on swap
+    bool holds(u64 pid) const {
+        for (const auto& e : pool) {
+            if (e.first.first == pid) return true;
+        }
+        for (const auto& e : swap) {
+            if (e.first.first == pid) return true;
+        }
+        return false;
+    }
+
+    // Fork: `child` gets its own copy of every stored page of `parent`.
+    // Pool copies go in parent-age order and may push older entries out
+    // to swap like any other store.
+    void clone(u64 parent, u64 child, u64 bytes) {
+        std::vector<Key> stored;
+        for (const Key& k : lru) {
+            if (k.first == parent) stored.push_back(k);
+        }
+        for (const Key& k : stored) {
+            auto it = pool.find(k);
+            if (it == pool.end()) continue; // Written back by an earlier copy
+            std::vector<unsigned char> blob = it->second.blob;
+            const u64 size = blob.size();
+            while (pool_bytes + size > limit) write_back_oldest(bytes);
+            Key key(child, k.second);
+            lru.push_back(key);
+            pool[key] = Entry{std::move(blob), std::prev(lru.end())};
+            pool_bytes += size;
+            if (pool_bytes > stats.peak_bytes) stats.peak_bytes = pool_bytes;
+        }
+        std::vector<std::pair<Key, std::vector<unsigned char>>> raw;
+        for (const auto& e : swap) {
+            if (e.first.first == parent) raw.push_back({Key(child, e.first.second), e.second});
+        }
+        for (auto& e : raw) swap[e.first] = std::move(e.second);
+    }
+
+private:
+    void erase(std::unordered_map<Key, Entry, ZswapKeyHash>::iterator it) {
+        pool_bytes -= it->second.blob.size();
+        lru.erase(it->second.age);
+        pool.erase(it);
+    }
+
+    void write_back_oldest(u64 bytes) {
+        auto it = pool.find(lru.front());
+        std::vector<unsigned char>& page = swap[it->first];
+        page.resize(bytes);
+        Lz_Decompress(it->second.blob.data(), it->second.blob.size(), page.data(), bytes);
+        stats.writebacks++;
+        erase(it);
+    }
+};
+
+#endif
@@ -5,10 +5,13 @@ GREEN='\033[0;32m'
 RED='\033[0;31m'
 NC='\033[0m'
 
+# Build directory (default: ./build, CTest passes its own)
+BUILD_DIR=${1:-./build}
+
 echo "--- Running Smoke Tests ---"
 
-# Test 1: Milestone 3 (LRU)
-if ./build/paging_sim_m3 > /dev/null; then
+# Test 1: Milestone 3 (LRU) - run the batch test from the menu, then exit
+if echo "1 0" | "$BUILD_DIR"/paging_sim_m3 > /dev/null; then
     echo -e "${GREEN}[PASS] Milestone 3 runs successfully.${NC}"
 else
     echo -e "${RED}[FAIL] Milestone 3 crashed!${NC}"
@@ -16,11 +19,294 @@ else
 fi
 
 # Test 2: Milestone 4 (Multi-Level)
-if ./build/paging_sim_m4 > /dev/null; then
+if "$BUILD_DIR"/paging_sim_m4 > /dev/null; then
     echo -e "${GREEN}[PASS] Milestone 4 runs successfully.${NC}"
 else
     echo -e "${RED}[FAIL] Milestone 4 crashed!${NC}"
     exit 1
 fi
 
+# Test 3: Milestone 5 (N-Level) - batch test must reclaim every table it built
+if echo "1 0" | "$BUILD_DIR"/paging_sim_m5 | grep -q "Live: 1 .*Reclaimed: 5"; then
+    echo -e "${GREEN}[PASS] Milestone 5 reclaims empty tables.${NC}"
+else
+    echo -e "${RED}[FAIL] Milestone 5 did not reclaim tables!${NC}"
+    exit 1
+fi
+
+# Test 4: Milestone 3 context-switch test - enough ASIDs must beat flushing
+if (cd "$BUILD_DIR" && echo "4 0" | ./paging_sim_m3 | grep -q "ASID x4 .* 2.5%"); then
+    echo -e "${GREEN}[PASS] ASID-tagged TLB avoids post-switch misses.${NC}"
+else
+    echo -e "${RED}[FAIL] Context-switch test regressed!${NC}"
+    exit 1
+fi
+
+# Test 5: WSClock on the built-in two-tenant trace
+if (cd "$BUILD_DIR" && ./paging_sim_ws | grep -q "Evictions:"); then
+    echo -e "${GREEN}[PASS] WSClock runs successfully.${NC}"
+else
+    echo -e "${RED}[FAIL] WSClock crashed!${NC}"
+    exit 1
+fi
+
+# Test 6: Generated multi-PID trace replays through the WSClock tool
+if (cd "$BUILD_DIR" && ./paging_tracegen pattern=phased pids=2 quantum=50 phase=1000 writes=0.2 count=5000 out=gen_trace.txt 2>/dev/null \
+    && ./paging_sim_ws gen_trace.txt 64 200 500 gen_ws.csv | grep -q "Evictions:"); then
+    echo -e "${GREEN}[PASS] Trace generator output replays successfully.${NC}"
+else
+    echo -e "${RED}[FAIL] Trace generator / replay failed!${NC}"
+    exit 1
+fi
+
+# Test 7: Benchmark harness runs every engine and emits one CSV row each
+if [ "$("$BUILD_DIR"/paging_bench sizes=256 accesses=10000 reps=1 patterns=seq 2>/dev/null | wc -l)" -eq 7 ]; then
+    echo -e "${GREEN}[PASS] Benchmark harness runs successfully.${NC}"
+else
+    echo -e "${RED}[FAIL] Benchmark harness failed!${NC}"
+    exit 1
+fi
+
+# Test 8: Interval stats export (CSV and columnar JSON)
+if (cd "$BUILD_DIR" && ./paging_sim_m4 stats_m4.csv 32 > /dev/null && grep -q "^192," stats_m4.csv \
+    && echo "1 0" | ./paging_sim_m3 stats_m3.json 1 > /dev/null && grep -q '"tlb_misses"' stats_m3.json); then
+    echo -e "${GREEN}[PASS] Interval stats exported.${NC}"
+else
+    echo -e "${RED}[FAIL] Interval stats export failed!${NC}"
+    exit 1
+fi
+
+# Test 9: Replay - every backend sees the same faults for the same stream
+REPLAY_FAULTS=$(cd "$BUILD_DIR" && for b in linear 2level 4level adaptive inverted clustered; do
+    ./paging_replay backend=$b pattern=zipf pages=512 pids=3 count=20000 frames=128 writes=0.2 \
+        | grep "Page Faults"; done | sort -u | wc -l)
+if [ "$REPLAY_FAULTS" -eq 1 ]; then
+    echo -e "${GREEN}[PASS] All backends agree under replay.${NC}"
+else
+    echo -e "${RED}[FAIL] Backends disagree under replay!${NC}"
+    exit 1
+fi
+
+# Test 10: Snapshot mid-run, restore, finish - same result as one straight run
+SNAP_OK=1
+for SNAP_ARGS in "backend=4level pattern=zipf pages=2000 pids=2 count=50000 frames=256 writes=0.3 data=1" \
+    "backend=2level pattern=zipf pages=2000 pids=3 count=50000 frames=256 policy=mglru mglru_interval=500"; do
+    # Wall-clock times and the latency profile (-DPAGING_PROFILE=ON) differ between any two runs
+    (cd "$BUILD_DIR" && ./paging_replay $SNAP_ARGS | grep -v "Elapsed" \
+        | sed -e 's/[0-9.]* ms (/(/' -e '/=== LATENCY PROFILE/,$d' > straight.txt \
+        && ./paging_replay $SNAP_ARGS save=mid.snap save_at=20000 > /dev/null \
+        && ./paging_replay restore=mid.snap count=50000 | grep -v "Elapsed\|Restored" \
+        | sed -e 's/[0-9.]* ms (/(/' -e '/=== LATENCY PROFILE/,$d' > resumed.txt \
+        && diff -q straight.txt resumed.txt > /dev/null) || SNAP_OK=0
+done
+if [ "$SNAP_OK" -eq 1 ]; then
+    echo -e "${GREEN}[PASS] Snapshot restore resumes exactly.${NC}"
+else
+    echo -e "${RED}[FAIL] Snapshot restore diverged!${NC}"
+    exit 1
+fi
+
+# Test 11: Sampled mode keeps faults exact and reports TLB estimates
+SAMPLE_ARGS="backend=2level pattern=zipf pages=3000 pids=2 count=200000 frames=1024"
+FULL_FAULTS=$(cd "$BUILD_DIR" && ./paging_replay $SAMPLE_ARGS | grep "Page Faults" | awk '{print $3}')
+SAMPLED=$(cd "$BUILD_DIR" && ./paging_replay $SAMPLE_ARGS sample=10000 sample_warmup=1000 sample_window=1000)
+if echo "$SAMPLED" | grep -q "Page Faults: *$FULL_FAULTS (exact)" && echo "$SAMPLED" | grep -q "^TLB Misses:"; then
+    echo -e "${GREEN}[PASS] Sampled simulation matches exact fault count.${NC}"
+else
+    echo -e "${RED}[FAIL] Sampled simulation diverged!${NC}"
+    exit 1
+fi
+
+# Test 12: Readahead turns a sequential scan's faults into prefetch hits
+RA_ARGS="backend=linear pattern=seq pages=20000 count=100000 frames=4096"
+BASE_FAULTS=$(cd "$BUILD_DIR" && ./paging_replay $RA_ARGS | grep "Page Faults" | awk '{print $3}')
+RA_OUT=$(cd "$BUILD_DIR" && ./paging_replay $RA_ARGS readahead=32)
+RA_FAULTS=$(echo "$RA_OUT" | grep "Page Faults" | awk '{print $3}')
+if [ "$RA_FAULTS" -lt $((BASE_FAULTS / 10)) ] && echo "$RA_OUT" | grep -q "^Prefetched:"; then
+    echo -e "${GREEN}[PASS] Readahead cuts sequential faults ($BASE_FAULTS -> $RA_FAULTS).${NC}"
+else
+    echo -e "${RED}[FAIL] Readahead did not reduce faults!${NC}"
+    exit 1
+fi
+
+# Test 13: Sparse address space - adaptive nodes use far less table memory
+SPARSE_ARGS="pattern=uniform pages=2000 count=50000 frames=4096 spread=512"
+FULL_BYTES=$(cd "$BUILD_DIR" && ./paging_replay backend=4level $SPARSE_ARGS | grep "Page-Table Bytes" | awk '{print $3}')
+ART_BYTES=$(cd "$BUILD_DIR" && ./paging_replay backend=adaptive $SPARSE_ARGS | grep "Page-Table Bytes" | awk '{print $3}')
+if [ "$ART_BYTES" -gt 0 ] && [ "$ART_BYTES" -lt $((FULL_BYTES / 20)) ]; then
+    echo -e "${GREEN}[PASS] Adaptive radix table is compact ($FULL_BYTES -> $ART_BYTES bytes).${NC}"
+else
+    echo -e "${RED}[FAIL] Adaptive radix table is not compact!${NC}"
+    exit 1
+fi
+
+# Test 14: Bulk trace ops translate once per page (1 MiB store + copy)
+printf 'S 1 0x10000000 1048576 x\nM 1 0x20000000 0x10000000 1048576\n' > "$BUILD_DIR/bulk.txt"
+BULK_OUT=$(cd "$BUILD_DIR" && ./paging_replay trace=bulk.txt frames=1024 data=1)
+if echo "$BULK_OUT" | grep -q "^Accesses: *768$" && echo "$BULK_OUT" | grep -q "^Page Faults: *512 "; then
+    echo -e "${GREEN}[PASS] Bulk ops translate once per page.${NC}"
+else
+    echo -e "${RED}[FAIL] Bulk ops translation count is wrong!${NC}"
+    exit 1
+fi
+
+# Test 15: Pre-fork server - children share the master's frames copy-on-write
+FORK_ARGS="pattern=zipf pages=2000 forks=3 count=100000 frames=16384 writes=0.1"
+FORK_OUT=$(cd "$BUILD_DIR" && ./paging_replay backend=inverted $FORK_ARGS)
+FORK_4L=$(cd "$BUILD_DIR" && ./paging_replay backend=4level $FORK_ARGS | grep "^Forks:")
+if echo "$FORK_OUT" | grep -q "^Page Faults: *2000 " && [ "$(echo "$FORK_OUT" | grep "^Forks:")" = "$FORK_4L" ] \
+    && echo "$FORK_OUT" | grep -q "^Forks: *3 (COW faults: [1-9][0-9]*, frames saved by sharing: [1-9]"; then
+    echo -e "${GREEN}[PASS] Fork shares frames and breaks COW on write.${NC}"
+else
+    echo -e "${RED}[FAIL] Copy-on-write fork is wrong!${NC}"
+    exit 1
+fi
+
+# Test 16: KSM merges identical frames under memory pressure and cuts faults
+KSM_ARGS="pattern=uniform pages=2000 forks=3 count=100000 frames=1024 writes=0.05"
+KSM_OFF=$(cd "$BUILD_DIR" && ./paging_replay $KSM_ARGS | grep "^Page Faults:" | awk '{print $3}')
+KSM_OUT=$(cd "$BUILD_DIR" && ./paging_replay $KSM_ARGS ksm=64 ksm_interval=100)
+KSM_ON=$(echo "$KSM_OUT" | grep "^Page Faults:" | awk '{print $3}')
+if echo "$KSM_OUT" | grep -q "^KSM: *[1-9][0-9]* merged" && [ "$KSM_ON" -lt "$KSM_OFF" ]; then
+    echo -e "${GREEN}[PASS] KSM merges duplicate pages (faults $KSM_OFF -> $KSM_ON).${NC}"
+else
+    echo -e "${RED}[FAIL] KSM did not merge pages or reduce faults!${NC}"
+    exit 1
+fi
+
+# Test 17: Zswap serves faults from the compressed pool and writes back when full
+ZS_OUT=$(cd "$BUILD_DIR" && ./paging_replay pattern=uniform pages=2000 count=100000 frames=1024 writes=0.2 zswap=1)
+if echo "$ZS_OUT" | grep -q "^Zswap: .* [1-9][0-9]* pool hits, [1-9][0-9]* swap-ins, [1-9][0-9]* written back" \
+    && echo "$ZS_OUT" | grep -q "^Zswap Pool: .*ratio [1-9][0-9]*\.[0-9]*x"; then
+    echo -e "${GREEN}[PASS] Zswap compresses evicted pages and writes back to swap.${NC}"
+else
+    echo -e "${RED}[FAIL] Zswap pool statistics are wrong!${NC}"
+    exit 1
+fi
+
+# Test 18: Tier daemon promotes hot pages and lowers the average memory cost
+TIER_ARGS="pattern=zipf pages=3000 count=300000 tiers=512:80,1024:140,2048:300 placement=interleave"
+TIER_OFF=$(cd "$BUILD_DIR" && ./paging_replay $TIER_ARGS tier_interval=0 | grep "^Memory Cost:" | awk '{print $3}')
+TIER_OUT=$(cd "$BUILD_DIR" && ./paging_replay $TIER_ARGS)
+TIER_ON=$(echo "$TIER_OUT" | grep "^Memory Cost:" | awk '{print $3}')
+if echo "$TIER_OUT" | grep -q "promotions: [1-9][0-9]*, demotions: [1-9]" && awk -v on="$TIER_ON" -v off="$TIER_OFF" 'BEGIN { exit !(on < off) }' \
+    && [ "$(echo "$TIER_OUT" | grep -c "^Node ")" = "3" ]; then
+    echo -e "${GREEN}[PASS] Tiering migrates pages (cost $TIER_OFF -> $TIER_ON ns/access).${NC}"
+else
+    echo -e "${RED}[FAIL] Tier migration did not lower the memory cost!${NC}"
+    exit 1
+fi
+
+# Test 19: Buddy allocator - contiguous DMA block, merges, fragmentation index
+BUDDY_OUT=$(echo "1 0" | "$BUILD_DIR"/paging_sim_m5)
+if echo "$BUDDY_OUT" | grep -q "\[DMA\] 8 contiguous frames: 8-15" \
+    && echo "$BUDDY_OUT" | grep -q "Free: 24/32 frames | Blocks by order: 0 0 0 1 1 0 | Splits: 5 Merges: 3" \
+    && echo "$BUDDY_OUT" | grep -q "Fragmentation index by order: - - - - - 0.1"; then
+    echo -e "${GREEN}[PASS] Buddy allocator splits, merges and reports fragmentation.${NC}"
+else
+    echo -e "${RED}[FAIL] Buddy allocator state is wrong!${NC}"
+    exit 1
+fi
+
+# Test 20: Per-CPU frame magazines batch trips to the global allocator
+PCP_OUT=$(echo "5 0" | "$BUILD_DIR"/paging_sim_m3)
+if echo "$PCP_OUT" | grep -Eq "^ +1 +0 +1998 +1998 +0.0%" \
+    && echo "$PCP_OUT" | grep -Eq "^ +8 +16 +1998 +4 +99.8%" \
+    && echo "$PCP_OUT" | grep -Eq "^ +16 +32 .* 0$"; then
+    echo -e "${GREEN}[PASS] Per-CPU magazines avoid global lock acquisitions.${NC}"
+else
+    echo -e "${RED}[FAIL] Per-CPU frame cache counters are wrong!${NC}"
+    exit 1
+fi
+
+# Test 21: Scan-resistant policies keep the hot set that LRU loses to a scan
+POLICY_OUT=$("$BUILD_DIR"/paging_replay pattern=scan pages=20000 loop=400 frames=512 count=100000 policy=lru,arc,2q,lirs)
+if echo "$POLICY_OUT" | awk '/POLICY COMPARISON/ { table = 1; next }
+        table && $1 != "Policy" { faults[$1] = $2 }
+        END { exit !(faults["lru"] > 0 && faults["arc"] * 1.3 < faults["lru"] && faults["2q"] * 1.3 < faults["lru"] &&
+                     faults["lirs"] * 1.3 < faults["lru"]) }'; then
+    echo -e "${GREEN}[PASS] ARC, 2Q and LIRS resist the scan.${NC}"
+else
+    echo -e "${RED}[FAIL] Scan-resistant policies did not beat LRU!${NC}"
+    exit 1
+fi
+
+# Test 22: MGLRU ages through page-table walks and stays close to exact LRU
+MGLRU_OUT=$("$BUILD_DIR"/paging_replay backend=4level pattern=zipf pages=20000 frames=512 count=200000 policy=lru,mglru)
+if echo "$MGLRU_OUT" | grep -Eq "^MGLRU: +[1-9][0-9]* walks" \
+    && echo "$MGLRU_OUT" | awk '/POLICY COMPARISON/ { table = 1; next }
+        table && $1 != "Policy" { faults[$1] = $2 }
+        END { exit !(faults["lru"] > 0 && faults["mglru"] < faults["lru"] * 1.05) }'; then
+    echo -e "${GREEN}[PASS] MGLRU aging walks track LRU within 5%.${NC}"
+else
+    echo -e "${RED}[FAIL] MGLRU did not age or fell far behind LRU!${NC}"
+    exit 1
+fi
+
+# Test 23: TLB prefetchers cover the strided streams they are built for
+PF_OUT=$(echo "6 0" | "$BUILD_DIR"/paging_sim_m3)
+if echo "$PF_OUT" | grep -Eq "^stride4 +sequential +1015 +1015 +0 .* 1015$" \
+    && echo "$PF_OUT" | grep -Eq "^stride4 +stride +21 +998 +994 +99.6%" \
+    && echo "$PF_OUT" | grep -Eq "^\+1/\+5 +distance +18 .* 98.2%" \
+    && echo "7 1 1 1 0" | "$BUILD_DIR"/paging_sim_m3 | grep -q "^TLB Prefetch (sequential): 3 buffer hits"; then
+    echo -e "${GREEN}[PASS] Stride and distance prefetchers remove the strided walks.${NC}"
+else
+    echo -e "${RED}[FAIL] TLB prefetch accuracy/coverage is wrong!${NC}"
+    exit 1
+fi
+
+# Test 24: Coalesced TLB entries cover contiguous runs
+COLT_OUT=$("$BUILD_DIR"/paging_replay backend=4level pattern=seq pages=2000 frames=4096 count=500000 tlb_coalesce=16)
+if echo "$COLT_OUT" | grep -Eq "^TLB Hits: +[0-9]+ \(9[0-9]\.[0-9]+%\)" \
+    && echo "$COLT_OUT" | grep -Eq "^TLB Coalescing: +up to 16 pages, [0-9]+ fills, 9[0-9]\.[0-9]+% coalesced" \
+    && echo "$COLT_OUT" | grep -Eq "^TLB Reach: +1024 pages in 64 entries"; then
+    echo -e "${GREEN}[PASS] Coalesced TLB entries extend the reach over contiguous runs.${NC}"
+else
+    echo -e "${RED}[FAIL] TLB coalescing did not raise the hit rate!${NC}"
+    exit 1
+fi
+
+# Test 25: Page walks go through the data caches and take LLC lines
+CACHE_OUT=$("$BUILD_DIR"/paging_replay backend=4level pattern=zipf pages=200000 frames=65536 count=200000 cache=32:8,1024:16,8192:16)
+if echo "$CACHE_OUT" | grep -Eq "^Cache LLC +8192 KiB 16-way: data [1-9][0-9]* / [1-9][0-9]* misses" \
+    && echo "$CACHE_OUT" | grep -Eq "^LLC Page Tables: +[1-9][0-9]* of 131072 lines now .* [1-9][0-9]* data lines evicted" \
+    && echo "$CACHE_OUT" | grep -Eq "^Walk References: +[1-9][0-9]* PTE loads in [1-9][0-9]* walks \(4\.00 per walk\)"; then
+    echo -e "${GREEN}[PASS] Cache model sees data and page-walk references.${NC}"
+else
+    echo -e "${RED}[FAIL] Page-walk references missing from the cache model!${NC}"
+    exit 1
+fi
+
+# Test 26: Accesses past the linear table's vpages fault before taking a frame
+RANGE_OUT=$("$BUILD_DIR"/paging_replay backend=linear vpages=65636 pattern=uniform pages=200 frames=16)
+if echo "$RANGE_OUT" | grep -Eq "^Seg Faults: +[1-9]" && echo "$RANGE_OUT" | grep -Eq "^Resident Frames: +16 / 16"; then
+    echo -e "${GREEN}[PASS] Out-of-range VPNs never evict a resident page.${NC}"
+else
+    echo -e "${RED}[FAIL] An out-of-range fault took a frame!${NC}"
+    exit 1
+fi
+
+# Test 27: A forked child inherits the parent's compressed pages and can't be forked over
+# PID 1 writes 8 pages into 4 frames (4 go to zswap), forks 2, and 2 reads all 8 -
+# every child fault is a pool hit. Once 2's pages are all swapped out, a second fork is refused.
+(for p in 0 1 2 3 4 5 6 7; do echo "W 1 0x${p}000 X"; done; echo "F 1 2"
+ for p in 0 1 2 3 4 5 6 7; do echo "R 2 0x${p}000"; done
+ for p in 8 9 a b c d e f; do echo "W 1 0x${p}000 Y"; done; echo "F 1 2") > "$BUILD_DIR"/fork_zswap.txt
+FZ_OUT=$(cd "$BUILD_DIR" && ./paging_replay trace=fork_zswap.txt frames=4 zswap=50)
+if echo "$FZ_OUT" | grep -q "^Zswap: .* 8 pool hits" && echo "$FZ_OUT" | grep -q "^Forks: *1 "; then
+    echo -e "${GREEN}[PASS] Fork copies the parent's zswap entries to the child.${NC}"
+else
+    echo -e "${RED}[FAIL] Forked child lost the parent's swapped-out pages!${NC}"
+    exit 1
+fi
+
+# Test 28: A malformed hex VA ends the trace instead of aborting the driver
+printf "W 1 0x1000 A\nR 1 zz\nR 1 0x2000\n" > "$BUILD_DIR"/bad_hex.txt
+if (cd "$BUILD_DIR" && ./paging_sim_ws bad_hex.txt 8 100 10 bad_hex.csv | grep -q "Evictions:"); then
+    echo -e "${GREEN}[PASS] Bad hex in a trace stops the read cleanly.${NC}"
+else
+    echo -e "${RED}[FAIL] Bad hex in a trace crashed the driver!${NC}"
+    exit 1
+fi
+
 echo "--- All Tests Passed ---"